@@ -11,108 +11,121 @@
 
 #if defined(TINY_GSM_MODEM_SIM800)
 #include "TinyGsmClientSIM800.h"
-typedef TinyGsmSim800                        TinyGsm;
-typedef TinyGsmSim800::GsmClientSim800       TinyGsmClient;
-typedef TinyGsmSim800::GsmClientSecureSim800 TinyGsmClientSecure;
+typedef TinyGsmSim800                                   TinyGsm;
+typedef TinyGsmClientRx<TinyGsmSim800::GsmClientSim800> TinyGsmClient;
+typedef TinyGsmClientRx<TinyGsmSim800::GsmClientSecureSim800>
+    TinyGsmClientSecure;
+typedef TinyGsmSim800::GsmClientTransparent TinyGsmClientTransparent;
 
 #elif defined(TINY_GSM_MODEM_SIM808) || defined(TINY_GSM_MODEM_SIM868)
 #include "TinyGsmClientSIM808.h"
-typedef TinyGsmSim808                        TinyGsm;
-typedef TinyGsmSim808::GsmClientSim800       TinyGsmClient;
-typedef TinyGsmSim808::GsmClientSecureSim800 TinyGsmClientSecure;
+typedef TinyGsmSim808                                   TinyGsm;
+typedef TinyGsmClientRx<TinyGsmSim808::GsmClientSim800> TinyGsmClient;
+typedef TinyGsmClientRx<TinyGsmSim808::GsmClientSecureSim800>
+    TinyGsmClientSecure;
+typedef TinyGsmSim808::GsmClientTransparent TinyGsmClientTransparent;
 
 #elif defined(TINY_GSM_MODEM_SIM900)
 #include "TinyGsmClientSIM800.h"
-typedef TinyGsmSim800                  TinyGsm;
-typedef TinyGsmSim800::GsmClientSim800 TinyGsmClient;
+typedef TinyGsmSim800                                   TinyGsm;
+typedef TinyGsmClientRx<TinyGsmSim800::GsmClientSim800> TinyGsmClient;
+typedef TinyGsmSim800::GsmClientTransparent TinyGsmClientTransparent;
 
 #elif defined(TINY_GSM_MODEM_SIM7000)
 #include "TinyGsmClientSIM7000.h"
-typedef TinyGsmSim7000                   TinyGsm;
-typedef TinyGsmSim7000::GsmClientSim7000 TinyGsmClient;
+typedef TinyGsmSim7000                                    TinyGsm;
+typedef TinyGsmClientRx<TinyGsmSim7000::GsmClientSim7000> TinyGsmClient;
 
 #elif defined(TINY_GSM_MODEM_SIM7000SSL)
 #include "TinyGsmClientSIM7000SSL.h"
-typedef TinyGsmSim7000SSL                            TinyGsm;
-typedef TinyGsmSim7000SSL::GsmClientSim7000SSL       TinyGsmClient;
-typedef TinyGsmSim7000SSL::GsmClientSecureSIM7000SSL TinyGsmClientSecure;
+typedef TinyGsmSim7000SSL                                       TinyGsm;
+typedef TinyGsmClientRx<TinyGsmSim7000SSL::GsmClientSim7000SSL> TinyGsmClient;
+typedef TinyGsmClientRx<TinyGsmSim7000SSL::GsmClientSecureSIM7000SSL>
+    TinyGsmClientSecure;
 
 #elif defined(TINY_GSM_MODEM_SIM7070) || defined(TINY_GSM_MODEM_SIM7080) || \
     defined(TINY_GSM_MODEM_SIM7090)
 #include "TinyGsmClientSIM7080.h"
-typedef TinyGsmSim7080                         TinyGsm;
-typedef TinyGsmSim7080::GsmClientSim7080       TinyGsmClient;
-typedef TinyGsmSim7080::GsmClientSecureSIM7080 TinyGsmClientSecure;
+typedef TinyGsmSim7080                                    TinyGsm;
+typedef TinyGsmClientRx<TinyGsmSim7080::GsmClientSim7080> TinyGsmClient;
+typedef TinyGsmClientRx<TinyGsmSim7080::GsmClientSecureSIM7080>
+    TinyGsmClientSecure;
 
 #elif defined(TINY_GSM_MODEM_SIM5320) || defined(TINY_GSM_MODEM_SIM5360) || \
     defined(TINY_GSM_MODEM_SIM5300) || defined(TINY_GSM_MODEM_SIM7100)
 #include "TinyGsmClientSIM5360.h"
-typedef TinyGsmSim5360                   TinyGsm;
-typedef TinyGsmSim5360::GsmClientSim5360 TinyGsmClient;
+typedef TinyGsmSim5360                                    TinyGsm;
+typedef TinyGsmClientRx<TinyGsmSim5360::GsmClientSim5360> TinyGsmClient;
 
 #elif defined(TINY_GSM_MODEM_SIM7600) || defined(TINY_GSM_MODEM_SIM7800) || \
     defined(TINY_GSM_MODEM_SIM7500)
 #include "TinyGsmClientSIM7600.h"
-typedef TinyGsmSim7600                   TinyGsm;
-typedef TinyGsmSim7600::GsmClientSim7600 TinyGsmClient;
-typedef TinyGsmSim7600::GsmClientSecureSim7600 TinyGsmClientSecure;
+typedef TinyGsmSim7600                                    TinyGsm;
+typedef TinyGsmClientRx<TinyGsmSim7600::GsmClientSim7600> TinyGsmClient;
+typedef TinyGsmClientRx<TinyGsmSim7600::GsmClientSecureSim7600>
+    TinyGsmClientSecure;
+typedef TinyGsmSim7600::GsmClientTransparent TinyGsmClientTransparent;
 
 #elif defined(TINY_GSM_MODEM_UBLOX)
 #include "TinyGsmClientUBLOX.h"
-typedef TinyGsmUBLOX                       TinyGsm;
-typedef TinyGsmUBLOX::GsmClientUBLOX       TinyGsmClient;
-typedef TinyGsmUBLOX::GsmClientSecureUBLOX TinyGsmClientSecure;
+typedef TinyGsmUBLOX                                        TinyGsm;
+typedef TinyGsmClientRx<TinyGsmUBLOX::GsmClientUBLOX>       TinyGsmClient;
+typedef TinyGsmClientRx<TinyGsmUBLOX::GsmClientSecureUBLOX> TinyGsmClientSecure;
 
 #elif defined(TINY_GSM_MODEM_SARAR4)
 #include "TinyGsmClientSaraR4.h"
-typedef TinyGsmSaraR4                    TinyGsm;
-typedef TinyGsmSaraR4::GsmClientSaraR4   TinyGsmClient;
-typedef TinyGsmSaraR4::GsmClientSecureR4 TinyGsmClientSecure;
+typedef TinyGsmSaraR4                                     TinyGsm;
+typedef TinyGsmClientRx<TinyGsmSaraR4::GsmClientSaraR4>   TinyGsmClient;
+typedef TinyGsmClientRx<TinyGsmSaraR4::GsmClientSecureR4> TinyGsmClientSecure;
 
 #elif defined(TINY_GSM_MODEM_M95)
 #include "TinyGsmClientM95.h"
-typedef TinyGsmM95               TinyGsm;
-typedef TinyGsmM95::GsmClientM95 TinyGsmClient;
+typedef TinyGsmM95                                TinyGsm;
+typedef TinyGsmClientRx<TinyGsmM95::GsmClientM95> TinyGsmClient;
 
 #elif defined(TINY_GSM_MODEM_BG96)
 #include "TinyGsmClientBG96.h"
-typedef TinyGsmBG96                TinyGsm;
-typedef TinyGsmBG96::GsmClientBG96 TinyGsmClient;
+typedef TinyGsmBG96                                 TinyGsm;
+typedef TinyGsmClientRx<TinyGsmBG96::GsmClientBG96> TinyGsmClient;
+typedef TinyGsmBG96::GsmClientTransparent           TinyGsmClientTransparent;
 
 #elif defined(TINY_GSM_MODEM_A6) || defined(TINY_GSM_MODEM_A7)
 #include "TinyGsmClientA6.h"
-typedef TinyGsmA6              TinyGsm;
-typedef TinyGsmA6::GsmClientA6 TinyGsmClient;
+typedef TinyGsmA6                               TinyGsm;
+typedef TinyGsmClientRx<TinyGsmA6::GsmClientA6> TinyGsmClient;
 
 #elif defined(TINY_GSM_MODEM_M590)
 #include "TinyGsmClientM590.h"
-typedef TinyGsmM590                TinyGsm;
-typedef TinyGsmM590::GsmClientM590 TinyGsmClient;
+typedef TinyGsmM590                                 TinyGsm;
+typedef TinyGsmClientRx<TinyGsmM590::GsmClientM590> TinyGsmClient;
 
 #elif defined(TINY_GSM_MODEM_MC60) || defined(TINY_GSM_MODEM_MC60E)
 #include "TinyGsmClientMC60.h"
-typedef TinyGsmMC60                TinyGsm;
-typedef TinyGsmMC60::GsmClientMC60 TinyGsmClient;
+typedef TinyGsmMC60                                 TinyGsm;
+typedef TinyGsmClientRx<TinyGsmMC60::GsmClientMC60> TinyGsmClient;
 
 #elif defined(TINY_GSM_MODEM_ESP8266)
 #define TINY_GSM_MODEM_HAS_WIFI
 #include "TinyGsmClientESP8266.h"
-typedef TinyGsmESP8266                         TinyGsm;
-typedef TinyGsmESP8266::GsmClientESP8266       TinyGsmClient;
-typedef TinyGsmESP8266::GsmClientSecureESP8266 TinyGsmClientSecure;
+typedef TinyGsmESP8266                                    TinyGsm;
+typedef TinyGsmClientRx<TinyGsmESP8266::GsmClientESP8266> TinyGsmClient;
+typedef TinyGsmClientRx<TinyGsmESP8266::GsmClientSecureESP8266>
+    TinyGsmClientSecure;
+typedef TinyGsmESP8266::GsmClientTransparent TinyGsmClientTransparent;
 
 #elif defined(TINY_GSM_MODEM_XBEE)
 #define TINY_GSM_MODEM_HAS_WIFI
 #include "TinyGsmClientXBee.h"
-typedef TinyGsmXBee                      TinyGsm;
-typedef TinyGsmXBee::GsmClientXBee       TinyGsmClient;
-typedef TinyGsmXBee::GsmClientSecureXBee TinyGsmClientSecure;
+typedef TinyGsmXBee                                       TinyGsm;
+typedef TinyGsmClientRx<TinyGsmXBee::GsmClientXBee>       TinyGsmClient;
+typedef TinyGsmClientRx<TinyGsmXBee::GsmClientSecureXBee> TinyGsmClientSecure;
 
 #elif defined(TINY_GSM_MODEM_SEQUANS_MONARCH)
 #include "TinyGsmClientSequansMonarch.h"
-typedef TinyGsmSequansMonarch                          TinyGsm;
-typedef TinyGsmSequansMonarch::GsmClientSequansMonarch TinyGsmClient;
-typedef TinyGsmSequansMonarch::GsmClientSecureSequansMonarch
+typedef TinyGsmSequansMonarch TinyGsm;
+typedef TinyGsmClientRx<TinyGsmSequansMonarch::GsmClientSequansMonarch>
+    TinyGsmClient;
+typedef TinyGsmClientRx<TinyGsmSequansMonarch::GsmClientSecureSequansMonarch>
     TinyGsmClientSecure;
 
 #else
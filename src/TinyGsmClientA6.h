@@ -14,23 +14,18 @@
 
 #define TINY_GSM_MUX_COUNT 8
 #define TINY_GSM_NO_MODEM_BUFFER
+// +CIPSEND takes at most 1024 bytes at a time
+#define TINY_GSM_MAX_SEND 1024
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmCalling.tpp"
 #include "TinyGsmGPRS.tpp"
+#include "TinyGsmPPP.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmTime.tpp"
 
-#define GSM_NL "\r\n"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
-#if defined       TINY_GSM_DEBUG
-static const char GSM_CME_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CME ERROR:";
-static const char GSM_CMS_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CMS ERROR:";
-#endif
-
 enum RegStatus {
   REG_NO_RESULT    = -1,
   REG_UNREGISTERED = 0,
@@ -43,6 +38,7 @@ enum RegStatus {
 
 class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
                   public TinyGsmGPRS<TinyGsmA6>,
+                  public TinyGsmPPP<TinyGsmA6>,
                   public TinyGsmTCP<TinyGsmA6, TINY_GSM_MUX_COUNT>,
                   public TinyGsmCalling<TinyGsmA6>,
                   public TinyGsmSMS<TinyGsmA6>,
@@ -50,6 +46,7 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
                   public TinyGsmBattery<TinyGsmA6> {
   friend class TinyGsmModem<TinyGsmA6>;
   friend class TinyGsmGPRS<TinyGsmA6>;
+  friend class TinyGsmPPP<TinyGsmA6>;
   friend class TinyGsmTCP<TinyGsmA6, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmCalling<TinyGsmA6>;
   friend class TinyGsmSMS<TinyGsmA6>;
@@ -94,6 +91,7 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
     TINY_GSM_CLIENT_CONNECT_OVERRIDES
 
     void stop(uint32_t maxWaitMs) {
+      flushTx();
       TINY_GSM_YIELD();
       at->sendAT(GF("+CIPCLOSE="), mux);
       sock_connected = false;
@@ -179,7 +177,7 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
   bool restartImpl(const char* pin = NULL) {
     if (!testAT()) { return false; }
     sendAT(GF("+RST=1"));
-    delay(3000);
+    waitForRestart(3000L);
     return init(pin);
   }
 
@@ -210,12 +208,9 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
 
   String getLocalIPImpl() {
     sendAT(GF("+CIFSR"));
-    String res;
+    char res[TINY_GSM_RESPONSE_BUFFER];
     if (waitResponse(10000L, res) != 1) { return ""; }
-    res.replace(GSM_NL "OK" GSM_NL, "");
-    res.replace(GSM_NL, "");
-    res.trim();
-    return res;
+    return cleanResponse(res, '\0');
   }
 
   /*
@@ -356,10 +351,8 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
    */
  protected:
   String sendUSSDImpl(const String& code) {
-    sendAT(GF("+CMGF=1"));
-    waitResponse();
-    sendAT(GF("+CSCS=\"HEX\""));
-    waitResponse();
+    sendATCached(SETTING_CMGF, 1, 1000L, GF("+CMGF=1"));
+    sendATCached(SETTING_CSCS, 1, 1000L, GF("+CSCS=\"HEX\""));
     sendAT(GF("+CUSD=1,\""), code, GF("\",15"));
     if (waitResponse(10000L) != 1) { return ""; }
     if (waitResponse(GF(GSM_NL "+CUSD:")) != 1) { return ""; }
@@ -440,7 +433,7 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
     sendAT(GF("+CIPSEND="), mux, ',', (uint16_t)len);
     if (waitResponse(2000L, GF(GSM_NL ">")) != 1) { return 0; }
-    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    modemWritePayload(buff, len);
     stream.flush();
     if (waitResponse(10000L, GFP(GSM_OK), GF(GSM_NL "FAIL")) != 1) { return 0; }
     return len;
@@ -455,118 +448,44 @@ class TinyGsmA6 : public TinyGsmModem<TinyGsmA6>,
   }
 
   /*
-   * Utilities
+   * URC handlers
    */
- public:
-  // TODO(vshymanskyy): Optimize this!
-  int8_t waitResponse(uint32_t timeout_ms, String& data,
-                      GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s);*/
-    data.reserve(64);
-    uint8_t  index       = 0;
-    uint32_t startMillis = millis();
-    do {
-      TINY_GSM_YIELD();
-      while (stream.available() > 0) {
-        TINY_GSM_YIELD();
-        int8_t a = stream.read();
-        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
-#if defined TINY_GSM_DEBUG
-          if (r3 == GFP(GSM_CME_ERROR)) {
-            streamSkipUntil('\n');  // Read out the error
-          }
-#endif
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
-          goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (data.endsWith(GF("+CIPRCV:"))) {
-          int8_t  mux      = streamGetIntBefore(',');
-          int16_t len      = streamGetIntBefore(',');
-          int16_t len_orig = len;
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            if (len > sockets[mux]->rx.free()) {
-              DBG("### Buffer overflow: ", len, "->", sockets[mux]->rx.free());
-            } else {
-              DBG("### Got: ", len, "->", sockets[mux]->rx.free());
-            }
-            while (len--) { moveCharFromStreamToFifo(mux); }
-            // TODO(?) Deal with missing characters
-            if (len_orig > sockets[mux]->available()) {
-              DBG("### Fewer characters received than expected: ",
-                  sockets[mux]->available(), " vs ", len_orig);
-            }
-          }
-          data = "";
-        } else if (data.endsWith(GF("+TCPCLOSED:"))) {
-          int8_t mux = streamGetIntBefore('\n');
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->sock_connected = false;
-          }
-          data = "";
-          DBG("### Closed: ", mux);
-        }
+ protected:
+  bool handleReceive() {
+    int8_t  mux = streamGetIntBefore(',');
+    int16_t len = streamGetIntBefore(',');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux] && len > 0) {
+      size_t room = sockets[mux]->rxFree();
+      if (static_cast<size_t>(len) > room) {
+        DBG("### Buffer overflow: ", len, "->", room);
+      } else {
+        DBG("### Got: ", len, "->", room);
+      }
+      size_t kept = moveBytesFromStreamToFifo(mux, len);
+      if (kept < TinyGsmMin(static_cast<size_t>(len), room)) {
+        DBG("### Fewer characters received than expected: ", kept, " vs ",
+            len);
       }
-    } while (millis() - startMillis < timeout_ms);
-  finish:
-    if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
     }
-    // data.replace(GSM_NL, "/");
-    // DBG('<', index, '>', data);
-    return index;
+    return true;
   }
 
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+  bool handleClosed() {
+    int8_t mux = streamGetIntBefore('\n');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->sock_connected = false;
+    }
+    DBG("### Closed: ", mux);
+    return true;
   }
 
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    return waitResponse(1000, r1, r2, r3, r4, r5);
+  const TinyGsmUrc<TinyGsmA6>* urcTable(uint8_t& count) {
+    static constexpr TinyGsmUrc<TinyGsmA6> urcs[] TINY_GSM_PROGMEM = {
+        {"+CIPRCV:", &TinyGsmA6::handleReceive},
+        {"+TCPCLOSED:", &TinyGsmA6::handleClosed},
+    };
+    count = sizeof(urcs) / sizeof(urcs[0]);
+    return urcs;
   }
 
  public:
@@ -14,10 +14,13 @@
 
 #define TINY_GSM_MUX_COUNT 12
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+// +QISEND takes at most 1460 bytes at a time
+#define TINY_GSM_MAX_SEND 1460
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmCalling.tpp"
 #include "TinyGsmGPRS.tpp"
+#include "TinyGsmPPP.tpp"
 #include "TinyGsmGPS.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
@@ -25,14 +28,7 @@
 #include "TinyGsmTemperature.tpp"
 #include "TinyGsmTime.tpp"
 #include "TinyGsmNTP.tpp"
-
-#define GSM_NL "\r\n"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
-#if defined       TINY_GSM_DEBUG
-static const char GSM_CME_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CME ERROR:";
-static const char GSM_CMS_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CMS ERROR:";
-#endif
+#include "TinyGsmTransparent.tpp"
 
 enum RegStatus {
   REG_NO_RESULT    = -1,
@@ -46,6 +42,7 @@ enum RegStatus {
 
 class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
                     public TinyGsmGPRS<TinyGsmBG96>,
+                    public TinyGsmPPP<TinyGsmBG96>,
                     public TinyGsmTCP<TinyGsmBG96, TINY_GSM_MUX_COUNT>,
                     public TinyGsmCalling<TinyGsmBG96>,
                     public TinyGsmSMS<TinyGsmBG96>,
@@ -53,9 +50,11 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
                     public TinyGsmNTP<TinyGsmBG96>,
                     public TinyGsmGPS<TinyGsmBG96>,
                     public TinyGsmBattery<TinyGsmBG96>,
-                    public TinyGsmTemperature<TinyGsmBG96> {
+                    public TinyGsmTemperature<TinyGsmBG96>,
+                    public TinyGsmTransparent<TinyGsmBG96> {
   friend class TinyGsmModem<TinyGsmBG96>;
   friend class TinyGsmGPRS<TinyGsmBG96>;
+  friend class TinyGsmPPP<TinyGsmBG96>;
   friend class TinyGsmTCP<TinyGsmBG96, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmCalling<TinyGsmBG96>;
   friend class TinyGsmSMS<TinyGsmBG96>;
@@ -64,6 +63,7 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
   friend class TinyGsmGPS<TinyGsmBG96>;
   friend class TinyGsmBattery<TinyGsmBG96>;
   friend class TinyGsmTemperature<TinyGsmBG96>;
+  friend class TinyGsmTransparent<TinyGsmBG96>;
 
   /*
    * Inner Client
@@ -294,10 +294,10 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
   String getSimCCIDImpl() {
     sendAT(GF("+QCCID"));
     if (waitResponse(GF(GSM_NL "+QCCID:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    char res[32];
+    streamGetStringBefore('\n', res, sizeof(res));
     waitResponse();
-    res.trim();
-    return res;
+    return cleanResponse(res);
   }
 
   /*
@@ -342,10 +342,10 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
   String getGPSrawImpl() {
     sendAT(GF("+QGPSLOC=2"));
     if (waitResponse(10000L, GF(GSM_NL "+QGPSLOC:")) != 1) { return ""; }
-    String res = stream.readStringUntil('\n');
+    char res[TINY_GSM_RESPONSE_BUFFER];
+    streamGetStringBefore('\n', res, sizeof(res));
     waitResponse();
-    res.trim();
-    return res;
+    return cleanResponse(res);
   }
 
   // get GPS informations
@@ -423,15 +423,16 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     sendAT(GF("+QLTS=2"));
     if (waitResponse(2000L, GF("+QLTS: \"")) != 1) { return ""; }
 
-    String res;
+    char res[32];
 
     switch (format) {
-      case DATE_FULL: res = stream.readStringUntil('"'); break;
+      case DATE_FULL: streamGetStringBefore('"', res, sizeof(res)); break;
       case DATE_TIME:
         streamSkipUntil(',');
-        res = stream.readStringUntil('"');
+        streamGetStringBefore('"', res, sizeof(res));
         break;
-      case DATE_DATE: res = stream.readStringUntil(','); break;
+      case DATE_DATE: streamGetStringBefore(',', res, sizeof(res)); break;
+      default: res[0] = '\0'; break;
     }
     waitResponse();  // Ends with OK
     return res;
@@ -489,10 +490,9 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     // AT+QNTP=<contextID>,<server>[,<port>][,<autosettime>]
     sendAT(GF("+QNTP=1,\""), server, '"');
     if (waitResponse(10000L, GF("+QNTP:"))) {
-      String result = stream.readStringUntil(',');
+      int16_t result = streamGetIntBefore(',');
       streamSkipUntil('\n');
-      result.trim();
-      if (TinyGsmIsValidNumber(result)) { return result.toInt(); }
+      if (result >= 0) { return result; }
     } else {
       return -1;
     }
@@ -525,6 +525,38 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     return res;
   }
 
+  /*
+   * Transparent mode functions
+   */
+ protected:
+  bool transparentConnectImpl(const char* host, uint16_t port, uint8_t mux,
+                              int timeout_s) {
+    uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
+    // Access mode 2 is transparent; the reply is CONNECT or ERROR
+    sendAT(GF("+QIOPEN=1,"), mux, GF(",\""), GF("TCP"), GF("\",\""), host,
+           GF("\","), port, GF(",0,2"));
+    if (waitResponse(timeout_ms, GF(GSM_NL "CONNECT"), GFP(GSM_ERROR)) != 1) {
+      return false;
+    }
+    streamSkipUntil('\n');  // The data starts after this line
+    return true;
+  }
+
+  void transparentStopImpl(uint8_t mux, uint32_t maxWaitMs) {
+    sendAT(GF("+QICLOSE="), mux);
+    waitResponse(maxWaitMs);
+  }
+
+  bool resumeDataModeImpl() {
+    sendAT(GF("+QISWTMD="), dataMux, GF(",2"));
+    if (waitResponse(GF(GSM_NL "CONNECT"), GFP(GSM_ERROR)) != 1) {
+      return false;
+    }
+    streamSkipUntil('\n');
+    dataMode = true;
+    return true;
+  }
+
   /*
    * Client related functions
    */
@@ -552,10 +584,10 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
     sendAT(GF("+QISEND="), mux, ',', (uint16_t)len);
     if (waitResponse(GF(">")) != 1) { return 0; }
-    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    modemWritePayload(buff, len);
     stream.flush();
     if (waitResponse(GF(GSM_NL "SEND OK")) != 1) { return 0; }
-    // TODO(?): Wait for ACK? AT+QISEND=id,0
+    // The remote end's ACK can be followed with modemGetPendingTx
     return len;
   }
 
@@ -587,6 +619,16 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
     return result;
   }
 
+  int16_t modemGetPendingTx(uint8_t mux) {
+    sendAT(GF("+QISEND="), mux, GF(",0"));
+    if (waitResponse(GF("+QISEND:")) != 1) { return -1; }
+    streamSkipUntil(',');  // Skip total sent
+    streamSkipUntil(',');  // Skip acknowledged
+    int16_t result = streamGetIntBefore('\n');
+    waitResponse();
+    return result;
+  }
+
   bool modemGetConnected(uint8_t mux) {
     sendAT(GF("+QISTATE=1,"), mux);
     // +QISTATE: 0,"TCP","151.139.237.11",80,5087,4,1,0,0,"uart1"
@@ -607,113 +649,38 @@ class TinyGsmBG96 : public TinyGsmModem<TinyGsmBG96>,
   }
 
   /*
-   * Utilities
+   * URC handlers
    */
- public:
-  // TODO(vshymanskyy): Optimize this!
-  int8_t waitResponse(uint32_t timeout_ms, String& data,
-                      GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s);*/
-    data.reserve(64);
-    uint8_t  index       = 0;
-    uint32_t startMillis = millis();
-    do {
-      TINY_GSM_YIELD();
-      while (stream.available() > 0) {
-        TINY_GSM_YIELD();
-        int8_t a = stream.read();
-        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
-#if defined TINY_GSM_DEBUG
-          if (r3 == GFP(GSM_CME_ERROR)) {
-            streamSkipUntil('\n');  // Read out the error
-          }
-#endif
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
-          goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (data.endsWith(GF(GSM_NL "+QIURC:"))) {
-          streamSkipUntil('\"');
-          String urc = stream.readStringUntil('\"');
-          streamSkipUntil(',');
-          if (urc == "recv") {
-            int8_t mux = streamGetIntBefore('\n');
-            DBG("### URC RECV:", mux);
-            if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-              sockets[mux]->got_data = true;
-            }
-          } else if (urc == "closed") {
-            int8_t mux = streamGetIntBefore('\n');
-            DBG("### URC CLOSE:", mux);
-            if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-              sockets[mux]->sock_connected = false;
-            }
-          } else {
-            streamSkipUntil('\n');
-          }
-          data = "";
-        }
+ protected:
+  bool handleSocketEvent() {
+    char urc[16];
+    streamSkipUntil('\"');
+    streamGetStringBefore('\"', urc, sizeof(urc));
+    streamSkipUntil(',');
+    if (!strcmp(urc, "recv")) {
+      int8_t mux = streamGetIntBefore('\n');
+      DBG("### URC RECV:", mux);
+      if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+        sockets[mux]->got_data = true;
       }
-    } while (millis() - startMillis < timeout_ms);
-  finish:
-    if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
+    } else if (!strcmp(urc, "closed")) {
+      int8_t mux = streamGetIntBefore('\n');
+      DBG("### URC CLOSE:", mux);
+      if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+        sockets[mux]->sock_connected = false;
+      }
+    } else {
+      streamSkipUntil('\n');
     }
-    // data.replace(GSM_NL, "/");
-    // DBG('<', index, '>', data);
-    return index;
-  }
-
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+    return true;
   }
 
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    return waitResponse(1000, r1, r2, r3, r4, r5);
+  const TinyGsmUrc<TinyGsmBG96>* urcTable(uint8_t& count) {
+    static constexpr TinyGsmUrc<TinyGsmBG96> urcs[] TINY_GSM_PROGMEM = {
+        {GSM_NL "+QIURC:", &TinyGsmBG96::handleSocketEvent},
+    };
+    count = sizeof(urcs) / sizeof(urcs[0]);
+    return urcs;
   }
 
  public:
@@ -14,15 +14,15 @@
 
 #define TINY_GSM_MUX_COUNT 5
 #define TINY_GSM_NO_MODEM_BUFFER
+// +CIPSEND takes at most 2048 bytes at a time
+#define TINY_GSM_MAX_SEND 2048
 
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSSL.tpp"
 #include "TinyGsmTCP.tpp"
+#include "TinyGsmTransparent.tpp"
 #include "TinyGsmWifi.tpp"
 
-#define GSM_NL "\r\n"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
 static uint8_t    TINY_GSM_TCP_KEEP_ALIVE      = 120;
 
 // <stat> status of ESP8266 station interface
@@ -41,11 +41,13 @@ enum RegStatus {
 class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
                        public TinyGsmWifi<TinyGsmESP8266>,
                        public TinyGsmTCP<TinyGsmESP8266, TINY_GSM_MUX_COUNT>,
-                       public TinyGsmSSL<TinyGsmESP8266> {
+                       public TinyGsmSSL<TinyGsmESP8266>,
+                       public TinyGsmTransparent<TinyGsmESP8266> {
   friend class TinyGsmModem<TinyGsmESP8266>;
   friend class TinyGsmWifi<TinyGsmESP8266>;
   friend class TinyGsmTCP<TinyGsmESP8266, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmSSL<TinyGsmESP8266>;
+  friend class TinyGsmTransparent<TinyGsmESP8266>;
 
   /*
    * Inner Client
@@ -86,6 +88,7 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
     TINY_GSM_CLIENT_CONNECT_OVERRIDES
 
     void stop(uint32_t maxWaitMs) {
+      flushTx();
       TINY_GSM_YIELD();
       at->sendAT(GF("+CIPCLOSE="), mux);
       sock_connected = false;
@@ -163,7 +166,7 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
     return "ESP8266";
   }
 
-  void setBaudImpl(uint32_t baud) {
+  bool setBaudImpl(uint32_t baud) {
     sendAT(GF("+UART_CUR="), baud, "8,1,0,0");
     if (waitResponse() != 1) {
       sendAT(GF("+UART="), baud,
@@ -171,9 +174,24 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
       // if (waitResponse() != 1) {
       //   sendAT(GF("+IPR="), baud);  // First release firmwares might need
       //   this
-      waitResponse();
+      return waitResponse() == 1;
       // }
     }
+    return true;
+  }
+
+  bool setFlowControlImpl(FlowControl mode) {
+    // The UART settings are only set all together, so keep the others
+    sendAT(GF("+UART_CUR?"));
+    if (waitResponse(GF("+UART_CUR:")) != 1) { return false; }
+    String settings = stream.readStringUntil('\n');
+    waitResponse();
+    settings.trim();
+    int last = settings.lastIndexOf(',');
+    if (last < 0) { return false; }
+    sendAT(GF("+UART_CUR="), settings.substring(0, last + 1),
+           mode == FLOW_CONTROL_RTSCTS ? 3 : 0);
+    return waitResponse() == 1;
   }
 
   bool factoryDefaultImpl() {
@@ -183,12 +201,9 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
 
   String getModemInfoImpl() {
     sendAT(GF("+GMR"));
-    String res;
+    char res[TINY_GSM_RESPONSE_BUFFER];
     if (waitResponse(1000L, res) != 1) { return ""; }
-    res.replace(GSM_NL "OK" GSM_NL, "");
-    res.replace(GSM_NL, " ");
-    res.trim();
-    return res;
+    return cleanResponse(res);
   }
 
   /*
@@ -251,6 +266,10 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
     return res2;
   }
 
+  bool enableRegistrationReportsImpl(int8_t*) {
+    return false;
+  }
+
   bool isNetworkConnectedImpl() {
     RegStatus s = getRegistrationStatus();
     if (s == REG_OK_IP || s == REG_OK_TCP) {
@@ -310,6 +329,47 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
     return retVal;
   }
 
+  /*
+   * Transparent mode functions
+   */
+ protected:
+  bool transparentConnectImpl(const char* host, uint16_t port, uint8_t,
+                              int timeout_s) {
+    uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
+    // Transparent transmission only works with a single connection
+    sendAT(GF("+CIPMUX=0"));
+    if (waitResponse() != 1) { return false; }
+    sendAT(GF("+CIPMODE=1"));
+    if (waitResponse() == 1) {
+      sendAT(GF("+CIPSTART=\"TCP\",\""), host, GF("\","), port, GF(","),
+             TINY_GSM_TCP_KEEP_ALIVE);
+      if (waitResponse(timeout_ms, GFP(GSM_OK), GFP(GSM_ERROR),
+                       GF("ALREADY CONNECT")) == 1 &&
+          resumeDataModeImpl()) {
+        return true;
+      }
+    }
+    transparentStopImpl(0, 1000L);
+    return false;
+  }
+
+  void transparentStopImpl(uint8_t, uint32_t maxWaitMs) {
+    sendAT(GF("+CIPCLOSE"));
+    waitResponse(maxWaitMs);
+    // Back to the multiple connections used by the other clients
+    sendAT(GF("+CIPMODE=0"));
+    waitResponse();
+    sendAT(GF("+CIPMUX=1"));
+    waitResponse();
+  }
+
+  bool resumeDataModeImpl() {
+    sendAT(GF("+CIPSEND"));
+    if (waitResponse(GF(">")) != 1) { return false; }
+    dataMode = true;
+    return true;
+  }
+
   /*
    * Client related functions
    */
@@ -335,7 +395,7 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
     sendAT(GF("+CIPSEND="), mux, ',', (uint16_t)len);
     if (waitResponse(GF(">")) != 1) { return 0; }
-    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    modemWritePayload(buff, len);
     stream.flush();
     if (waitResponse(10000L, GF(GSM_NL "SEND OK" GSM_NL)) != 1) { return 0; }
     return len;
@@ -379,99 +439,44 @@ class TinyGsmESP8266 : public TinyGsmModem<TinyGsmESP8266>,
   }
 
   /*
-   * Utilities
+   * URC handlers
    */
- public:
-  // TODO(vshymanskyy): Optimize this!
-  int8_t waitResponse(uint32_t timeout_ms, String& data,
-                      GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR), GsmConstStr r3 = NULL,
-                      GsmConstStr r4 = NULL, GsmConstStr r5 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s);*/
-    data.reserve(64);
-    uint8_t  index       = 0;
-    uint32_t startMillis = millis();
-    do {
-      TINY_GSM_YIELD();
-      while (stream.available() > 0) {
-        TINY_GSM_YIELD();
-        int8_t a = stream.read();
-        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
-          goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (data.endsWith(GF("+IPD,"))) {
-          int8_t  mux      = streamGetIntBefore(',');
-          int16_t len      = streamGetIntBefore(':');
-          int16_t len_orig = len;
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            if (len > sockets[mux]->rx.free()) {
-              DBG("### Buffer overflow: ", len, "received vs",
-                  sockets[mux]->rx.free(), "available");
-            } else {
-              // DBG("### Got Data: ", len, "on", mux);
-            }
-            while (len--) { moveCharFromStreamToFifo(mux); }
-            // TODO(SRGDamia1): deal with buffer overflow/missed characters
-            if (len_orig > sockets[mux]->available()) {
-              DBG("### Fewer characters received than expected: ",
-                  sockets[mux]->available(), " vs ", len_orig);
-            }
-          }
-          data = "";
-        } else if (data.endsWith(GF("CLOSED"))) {
-          int8_t muxStart =
-              TinyGsmMax(0, data.lastIndexOf(GSM_NL, data.length() - 8));
-          int8_t coma = data.indexOf(',', muxStart);
-          int8_t mux  = data.substring(muxStart, coma).toInt();
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->sock_connected = false;
-          }
-          data = "";
-          DBG("### Closed: ", mux);
-        }
+ protected:
+  bool handleReceive() {
+    int8_t  mux = streamGetIntBefore(',');
+    int16_t len = streamGetIntBefore(':');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux] && len > 0) {
+      size_t room = sockets[mux]->rxFree();
+      if (static_cast<size_t>(len) > room) {
+        DBG("### Buffer overflow: ", len, "received vs", room, "available");
+      } else {
+        // DBG("### Got Data: ", len, "on", mux);
+      }
+      size_t kept = moveBytesFromStreamToFifo(mux, len);
+      if (kept < TinyGsmMin(static_cast<size_t>(len), room)) {
+        DBG("### Fewer characters received than expected: ", kept, " vs ",
+            len);
       }
-    } while (millis() - startMillis < timeout_ms);
-  finish:
-    if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
     }
-    // data.replace(GSM_NL, "/");
-    // DBG('<', index, '>', data);
-    return index;
+    return true;
   }
 
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR), GsmConstStr r3 = NULL,
-                      GsmConstStr r4 = NULL, GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+  bool handleClosed() {
+    int8_t mux = matcher.lineInt();  // "<mux>,CLOSED"
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->sock_connected = false;
+    }
+    DBG("### Closed: ", mux);
+    return true;
   }
 
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR), GsmConstStr r3 = NULL,
-                      GsmConstStr r4 = NULL, GsmConstStr r5 = NULL) {
-    return waitResponse(1000, r1, r2, r3, r4, r5);
+  const TinyGsmUrc<TinyGsmESP8266>* urcTable(uint8_t& count) {
+    static constexpr TinyGsmUrc<TinyGsmESP8266> urcs[] TINY_GSM_PROGMEM = {
+        {"+IPD,", &TinyGsmESP8266::handleReceive},
+        {"CLOSED", &TinyGsmESP8266::handleClosed},
+    };
+    count = sizeof(urcs) / sizeof(urcs[0]);
+    return urcs;
   }
 
  public:
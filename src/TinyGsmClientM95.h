@@ -15,24 +15,19 @@
 
 #define TINY_GSM_MUX_COUNT 6
 #define TINY_GSM_BUFFER_READ_NO_CHECK
+// +QISEND takes at most 1460 bytes at a time
+#define TINY_GSM_MAX_SEND 1460
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmCalling.tpp"
 #include "TinyGsmGPRS.tpp"
+#include "TinyGsmPPP.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmTemperature.tpp"
 #include "TinyGsmTime.tpp"
 
-#define GSM_NL "\r\n"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
-#if defined       TINY_GSM_DEBUG
-static const char GSM_CME_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CME ERROR:";
-static const char GSM_CMS_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CMS ERROR:";
-#endif
-
 enum RegStatus {
   REG_NO_RESULT    = -1,
   REG_UNREGISTERED = 0,
@@ -45,6 +40,7 @@ enum RegStatus {
 
 class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
                    public TinyGsmGPRS<TinyGsmM95>,
+                   public TinyGsmPPP<TinyGsmM95>,
                    public TinyGsmTCP<TinyGsmM95, TINY_GSM_MUX_COUNT>,
                    public TinyGsmCalling<TinyGsmM95>,
                    public TinyGsmSMS<TinyGsmM95>,
@@ -53,6 +49,7 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
                    public TinyGsmTemperature<TinyGsmM95> {
   friend class TinyGsmModem<TinyGsmM95>;
   friend class TinyGsmGPRS<TinyGsmM95>;
+  friend class TinyGsmPPP<TinyGsmM95>;
   friend class TinyGsmTCP<TinyGsmM95, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmCalling<TinyGsmM95>;
   friend class TinyGsmSMS<TinyGsmM95>;
@@ -424,7 +421,7 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
     sendAT(GF("+QISEND="), mux, ',', (uint16_t)len);
     if (waitResponse(GF(">")) != 1) { return 0; }
-    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    modemWritePayload(buff, len);
     stream.flush();
     if (waitResponse(GF(GSM_NL "SEND OK")) != 1) { return 0; }
 
@@ -492,6 +489,16 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
     return 0;
   }
 
+  int16_t modemGetPendingTx(uint8_t mux) {
+    sendAT(GF("+QISACK="), mux);
+    if (waitResponse(5000L, GF(GSM_NL "+QISACK:")) != 1) { return -1; }
+    streamSkipUntil(',');  // Skip total sent
+    streamSkipUntil(',');  // Skip acknowledged
+    int16_t result = streamGetIntBefore('\n');
+    waitResponse(5000L);
+    return result;
+  }
+
   bool modemGetConnected(uint8_t mux) {
     sendAT(GF("+QISTATE=1,"), mux);
     // +QISTATE: 0,"TCP","151.139.237.11",80,5087,4,1,0,0,"uart1"
@@ -512,117 +519,45 @@ class TinyGsmM95 : public TinyGsmModem<TinyGsmM95>,
   }
 
   /*
-   * Utilities
+   * URC handlers
    */
- public:
-  // TODO(vshymanskyy): Optimize this!
-  int8_t waitResponse(uint32_t timeout_ms, String& data,
-                      GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s);*/
-    data.reserve(64);
-    uint8_t  index       = 0;
-    uint32_t startMillis = millis();
-    do {
-      TINY_GSM_YIELD();
-      while (stream.available() > 0) {
-        TINY_GSM_YIELD();
-        int8_t a = stream.read();
-        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
-#if defined TINY_GSM_DEBUG
-          if (r3 == GFP(GSM_CME_ERROR)) {
-            streamSkipUntil('\n');  // Read out the error
-          }
-#endif
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
-          goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (data.endsWith(GF(GSM_NL "+QIRDI:"))) {
-          streamSkipUntil(',');  // Skip the context
-          streamSkipUntil(',');  // Skip the role
-          int8_t mux = streamGetIntBefore('\n');
-          // DBG("### Got Data:", mux);
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            // We have no way of knowing how much data actually came in, so
-            // we set the value to 1500, the maximum possible size.
-            sockets[mux]->sock_available = 1500;
-          }
-          data = "";
-        } else if (data.endsWith(GF("CLOSED" GSM_NL))) {
-          int8_t nl   = data.lastIndexOf(GSM_NL, data.length() - 8);
-          int8_t coma = data.indexOf(',', nl + 2);
-          int8_t mux  = data.substring(nl + 2, coma).toInt();
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->sock_connected = false;
-          }
-          data = "";
-          DBG("### Closed: ", mux);
-        } else if (data.endsWith(GF("+QNITZ:"))) {
-          streamSkipUntil('\n');  // URC for time sync
-          data = "";
-          DBG("### Network time updated.");
-        }
-      }
-    } while (millis() - startMillis < timeout_ms);
-  finish:
-    if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
+ protected:
+  bool handleDataIndication() {
+    streamSkipUntil(',');  // Skip the context
+    streamSkipUntil(',');  // Skip the role
+    int8_t mux = streamGetIntBefore('\n');
+    // DBG("### Got Data:", mux);
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      // We have no way of knowing how much data actually came in, so
+      // we set the value to 1500, the maximum possible size.
+      sockets[mux]->sock_available = 1500;
     }
-    // data.replace(GSM_NL, "/");
-    // DBG('<', index, '>', data);
-    return index;
+    return true;
   }
 
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+  bool handleClosed() {
+    int8_t mux = matcher.lineInt();  // "<mux>, CLOSED"
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->sock_connected = false;
+    }
+    DBG("### Closed: ", mux);
+    return true;
   }
 
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    return waitResponse(1000, r1, r2, r3, r4, r5);
+  bool handleNetworkTime() {
+    streamSkipUntil('\n');  // URC for time sync
+    DBG("### Network time updated.");
+    return true;
+  }
+
+  const TinyGsmUrc<TinyGsmM95>* urcTable(uint8_t& count) {
+    static constexpr TinyGsmUrc<TinyGsmM95> urcs[] TINY_GSM_PROGMEM = {
+        {GSM_NL "+QIRDI:", &TinyGsmM95::handleDataIndication},
+        {"CLOSED" GSM_NL, &TinyGsmM95::handleClosed},
+        {"+QNITZ:", &TinyGsmM95::handleNetworkTime},
+    };
+    count = sizeof(urcs) / sizeof(urcs[0]);
+    return urcs;
   }
 
  public:
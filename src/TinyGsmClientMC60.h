@@ -17,23 +17,18 @@
 
 #define TINY_GSM_MUX_COUNT 6
 #define TINY_GSM_BUFFER_READ_NO_CHECK
+// +QISEND takes at most 1460 bytes at a time
+#define TINY_GSM_MAX_SEND 1460
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmCalling.tpp"
 #include "TinyGsmGPRS.tpp"
+#include "TinyGsmPPP.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmTime.tpp"
 
-#define GSM_NL "\r\n"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
-#if defined       TINY_GSM_DEBUG
-static const char GSM_CME_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CME ERROR:";
-static const char GSM_CMS_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CMS ERROR:";
-#endif
-
 enum RegStatus {
   REG_NO_RESULT    = -1,
   REG_UNREGISTERED = 0,
@@ -46,6 +41,7 @@ enum RegStatus {
 
 class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
                     public TinyGsmGPRS<TinyGsmMC60>,
+                    public TinyGsmPPP<TinyGsmMC60>,
                     public TinyGsmTCP<TinyGsmMC60, TINY_GSM_MUX_COUNT>,
                     public TinyGsmCalling<TinyGsmMC60>,
                     public TinyGsmSMS<TinyGsmMC60>,
@@ -53,6 +49,7 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
                     public TinyGsmBattery<TinyGsmMC60> {
   friend class TinyGsmModem<TinyGsmMC60>;
   friend class TinyGsmGPRS<TinyGsmMC60>;
+  friend class TinyGsmPPP<TinyGsmMC60>;
   friend class TinyGsmTCP<TinyGsmMC60, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmCalling<TinyGsmMC60>;
   friend class TinyGsmSMS<TinyGsmMC60>;
@@ -201,7 +198,7 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
     if (!testAT()) { return false; }
     if (!setPhoneFunctionality(0)) { return false; }
     if (!setPhoneFunctionality(1, true)) { return false; }
-    delay(3000);
+    waitForRestart(3000L);
     return init(pin);
   }
 
@@ -397,24 +394,14 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
     sendAT(GF("+QISEND="), mux, ',', (uint16_t)len);
     if (waitResponse(GF(">")) != 1) { return 0; }
-    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    modemWritePayload(buff, len);
     stream.flush();
     if (waitResponse(GF(GSM_NL "SEND OK")) != 1) { return 0; }
 
-    bool allAcknowledged = false;
-    // bool failed = false;
-    while (!allAcknowledged) {
-      sendAT(GF("+QISACK="), mux);  // If 'mux' is not specified, MC60 returns
-                                    // 'ERRROR' (for QIMUX == 1)
-      if (waitResponse(5000L, GF(GSM_NL "+QISACK:")) != 1) {
-        return -1;
-      } else {
-        streamSkipUntil(','); /** Skip total */
-        streamSkipUntil(','); /** Skip acknowledged data size */
-        if (streamGetIntBefore('\n') == 0) { allAcknowledged = true; }
-      }
-    }
-    waitResponse(5000L);
+    // Wait for the remote end to acknowledge everything
+    int16_t pending;
+    while ((pending = modemGetPendingTx(mux)) > 0) {}
+    if (pending < 0) { return -1; }
 
     // streamSkipUntil(','); // Skip mux
     // return streamGetIntBefore('\n');
@@ -465,6 +452,17 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
     return 0;
   }
 
+  int16_t modemGetPendingTx(uint8_t mux) {
+    // If 'mux' is not specified, MC60 returns 'ERRROR' (for QIMUX == 1)
+    sendAT(GF("+QISACK="), mux);
+    if (waitResponse(5000L, GF(GSM_NL "+QISACK:")) != 1) { return -1; }
+    streamSkipUntil(',');  // Skip total sent
+    streamSkipUntil(',');  // Skip acknowledged
+    int16_t result = streamGetIntBefore('\n');
+    waitResponse(5000L);
+    return result;
+  }
+
   bool modemGetConnected(uint8_t mux) {
     sendAT(GF("+QISTATE=1,"), mux);
     // +QISTATE: 0,"TCP","151.139.237.11",80,5087,4,1,0,0,"uart1"
@@ -485,130 +483,66 @@ class TinyGsmMC60 : public TinyGsmModem<TinyGsmMC60>,
   }
 
   /*
-   * Utilities
+   * URC handlers
    */
- public:
-  // TODO(vshymanskyy): Optimize this!
-  int8_t waitResponse(uint32_t timeout_ms, String& data,
-                      GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL, GsmConstStr r6 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    String r6s(r6); r6s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s, ",", r6s);*/
-    data.reserve(64);
-    uint8_t  index       = 0;
-    uint32_t startMillis = millis();
-    do {
-      TINY_GSM_YIELD();
-      while (stream.available() > 0) {
-        TINY_GSM_YIELD();
-        int8_t a = stream.read();
-        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
-#if defined TINY_GSM_DEBUG
-          if (r3 == GFP(GSM_CME_ERROR)) {
-            streamSkipUntil('\n');  // Read out the error
-          }
-#endif
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
-          goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (r6 && data.endsWith(r6)) {
-          index = 6;
-          goto finish;
-        } else if (data.endsWith(
-                       GF(GSM_NL "+QIRDI:"))) {  // TODO(?):  QIRD? or QIRDI?
-          // +QIRDI: <id>,<sc>,<sid>,<num>,<len>,< tlen>
-          streamSkipUntil(',');  // Skip the context
-          streamSkipUntil(',');  // Skip the role
-          // read the connection id
-          int8_t mux = streamGetIntBefore(',');
-          // read the number of packets in the buffer
-          int8_t num_packets = streamGetIntBefore(',');
-          // read the length of the current packet
-          streamSkipUntil(
-              ',');  // Skip the length of the current package in the buffer
-          int16_t len_total =
-              streamGetIntBefore('\n');  // Total length of all packages
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux] &&
-              num_packets >= 0 && len_total >= 0) {
-            sockets[mux]->sock_available = len_total;
-          }
-          data = "";
-          // DBG("### Got Data:", len_total, "on", mux);
-        } else if (data.endsWith(GF("CLOSED" GSM_NL))) {
-          int8_t nl   = data.lastIndexOf(GSM_NL, data.length() - 8);
-          int8_t coma = data.indexOf(',', nl + 2);
-          int8_t mux  = data.substring(nl + 2, coma).toInt();
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->sock_connected = false;
-          }
-          data = "";
-          DBG("### Closed: ", mux);
-        } else if (data.endsWith(GF("+QNITZ:"))) {
-          streamSkipUntil('\n');  // URC for time sync
-          DBG("### Network time updated.");
-          data = "";
-        }
-      }
-    } while (millis() - startMillis < timeout_ms);
-  finish:
-    if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
+ protected:
+  // TODO(?):  QIRD? or QIRDI?
+  bool handleDataIndication() {
+    // +QIRDI: <id>,<sc>,<sid>,<num>,<len>,< tlen>
+    streamSkipUntil(',');  // Skip the context
+    streamSkipUntil(',');  // Skip the role
+    // read the connection id
+    int8_t mux = streamGetIntBefore(',');
+    // read the number of packets in the buffer
+    int8_t num_packets = streamGetIntBefore(',');
+    // read the length of the current packet
+    streamSkipUntil(
+        ',');  // Skip the length of the current package in the buffer
+    int16_t len_total =
+        streamGetIntBefore('\n');  // Total length of all packages
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux] &&
+        num_packets >= 0 && len_total >= 0) {
+      sockets[mux]->sock_available = len_total;
     }
-    // data.replace(GSM_NL, "/");
-    // DBG('<', index, '>', data);
-    return index;
+    // DBG("### Got Data:", len_total, "on", mux);
+    return true;
   }
 
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL, GsmConstStr r6 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5, r6);
+  bool handleClosed() {
+    int8_t mux = matcher.lineInt();  // "<mux>, CLOSED"
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->sock_connected = false;
+    }
+    DBG("### Closed: ", mux);
+    return true;
   }
 
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL, GsmConstStr r6 = NULL) {
-    return waitResponse(1000, r1, r2, r3, r4, r5, r6);
+  bool handleNetworkTime() {
+    streamSkipUntil('\n');  // URC for time sync
+    DBG("### Network time updated.");
+    return true;
+  }
+
+  const TinyGsmUrc<TinyGsmMC60>* urcTable(uint8_t& count) {
+    static constexpr TinyGsmUrc<TinyGsmMC60> urcs[] TINY_GSM_PROGMEM = {
+        {GSM_NL "+QIRDI:", &TinyGsmMC60::handleDataIndication},
+        {"CLOSED" GSM_NL, &TinyGsmMC60::handleClosed},
+        {"+QNITZ:", &TinyGsmMC60::handleNetworkTime},
+    };
+    count = sizeof(urcs) / sizeof(urcs[0]);
+    return urcs;
+  }
+
+  /*
+   * Utilities
+   */
+ public:
+  using TinyGsmModem<TinyGsmMC60>::waitResponse;
+
+  // Checking the SIM status needs a sixth possible response
+  int8_t waitResponse(GsmConstStr r1, GsmConstStr r2, GsmConstStr r3,
+                      GsmConstStr r4, GsmConstStr r5, GsmConstStr r6) {
+    return waitResponseImpl(1000, TinyGsmCapture(), r1, r2, r3, r4, r5, r6);
   }
 
  public:
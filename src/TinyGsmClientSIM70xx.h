@@ -14,6 +14,7 @@
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmGPRS.tpp"
+#include "TinyGsmPPP.tpp"
 #include "TinyGsmGPS.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
@@ -21,14 +22,6 @@
 #include "TinyGsmNTP.tpp"
 #include "TinyGsmGSMLocation.tpp"
 
-#define GSM_NL "\r\n"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
-#if defined       TINY_GSM_DEBUG
-static const char GSM_CME_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CME ERROR:";
-static const char GSM_CMS_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CMS ERROR:";
-#endif
-
 enum RegStatus {
   REG_NO_RESULT    = -1,
   REG_UNREGISTERED = 0,
@@ -42,6 +35,7 @@ enum RegStatus {
 template <class modemType>
 class TinyGsmSim70xx : public TinyGsmModem<TinyGsmSim70xx<modemType>>,
                        public TinyGsmGPRS<TinyGsmSim70xx<modemType>>,
+                       public TinyGsmPPP<TinyGsmSim70xx<modemType>>,
                        public TinyGsmSMS<TinyGsmSim70xx<modemType>>,
                        public TinyGsmGPS<TinyGsmSim70xx<modemType>>,
                        public TinyGsmTime<TinyGsmSim70xx<modemType>>,
@@ -50,6 +44,7 @@ class TinyGsmSim70xx : public TinyGsmModem<TinyGsmSim70xx<modemType>>,
                        public TinyGsmGSMLocation<TinyGsmSim70xx<modemType>> {
   friend class TinyGsmModem<TinyGsmSim70xx<modemType>>;
   friend class TinyGsmGPRS<TinyGsmSim70xx<modemType>>;
+  friend class TinyGsmPPP<TinyGsmSim70xx<modemType>>;
   friend class TinyGsmSMS<TinyGsmSim70xx<modemType>>;
   friend class TinyGsmGPS<TinyGsmSim70xx<modemType>>;
   friend class TinyGsmTime<TinyGsmSim70xx<modemType>>;
@@ -86,13 +81,13 @@ class TinyGsmSim70xx : public TinyGsmModem<TinyGsmSim70xx<modemType>>,
     String name = "SIMCom SIM7000";
 
     thisModem().sendAT(GF("+GMM"));
-    String res2;
-    if (thisModem().waitResponse(5000L, res2) != 1) { return name; }
-    res2.replace(GSM_NL "OK" GSM_NL, "");
-    res2.replace("_", " ");
-    res2.trim();
+    char res[TINY_GSM_RESPONSE_BUFFER];
+    if (thisModem().waitResponse(5000L, res) != 1) { return name; }
+    for (char* c = res; *c; c++) {
+      if (*c == '_') { *c = ' '; }
+    }
 
-    name = res2;
+    name = thisModem().cleanResponse(res);
     return name;
   }
 
@@ -407,46 +402,51 @@ class TinyGsmSim70xx : public TinyGsmModem<TinyGsmSim70xx<modemType>>,
   // should implement in sub-classes
 
   /*
-   * Utilities
+   * URC handlers
    */
- public:
-  // should implement in sub-classes
-  int8_t waitResponse(uint32_t timeout_ms, String& data,
-                      GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    return thisModem().waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
-  }
-
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    String data;
-    return thisModem().waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
-  }
-
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    return thisModem().waitResponse(1000, r1, r2, r3, r4, r5);
+ protected:
+  // URC's shared by the whole family; the table itself is in the sub-classes.
+  // Without one of its own, a sub-class would land back here for good.
+  const TinyGsmUrc<modemType>* urcTable(uint8_t& count) {
+    static_assert(
+        TinyGsmIsSame<decltype(&modemType::urcTable),
+                      const TinyGsmUrc<modemType>* (modemType::*)(uint8_t&)>::
+            value,
+        "A SIM70xx modem must declare its own urcTable()");
+    return thisModem().urcTable(count);
+  }
+
+  bool handleNetworkName() {
+    thisModem().streamSkipUntil('\n');  // Refresh network name by network
+    DBG("### Network name updated.");
+    return true;
+  }
+
+  bool handleNetworkTime() {
+    // Refresh time and time zone by network
+    thisModem().streamSkipUntil('\n');
+    DBG("### Network time and time zone updated.");
+    return true;
+  }
+
+  bool handleTimeZone() {
+    // Refresh network time zone by network
+    thisModem().streamSkipUntil('\n');
+    DBG("### Network time zone updated.");
+    return true;
+  }
+
+  bool handleDaylightSaving() {
+    // Refresh Network Daylight Saving Time by network
+    thisModem().streamSkipUntil('\n');
+    DBG("### Daylight savings time state updated.");
+    return true;
+  }
+
+  bool handleModuleReset() {
+    DBG("### Unexpected module reset!");
+    thisModem().init();
+    return true;
   }
 
  public:
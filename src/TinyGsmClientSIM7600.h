@@ -14,11 +14,14 @@
 
 #define TINY_GSM_MUX_COUNT 10
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+// +CIPSEND takes at most 1500 bytes at a time, +CCHSEND 2048
+#define TINY_GSM_MAX_SEND 1500
 
 #include <utility>
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmCalling.tpp"
 #include "TinyGsmGPRS.tpp"
+#include "TinyGsmPPP.tpp"
 #include "TinyGsmGPS.tpp"
 #include "TinyGsmGSMLocation.tpp"
 #include "TinyGsmModem.tpp"
@@ -27,15 +30,7 @@
 #include "TinyGsmTemperature.tpp"
 #include "TinyGsmTime.tpp"
 #include "TinyGsmNTP.tpp"
-
-
-#define GSM_NL "\r\n"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
-#if defined       TINY_GSM_DEBUG
-static const char GSM_CME_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CME ERROR:";
-static const char GSM_CMS_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CMS ERROR:";
-#endif
+#include "TinyGsmTransparent.tpp"
 
 enum RegStatus {
   REG_NO_RESULT    = -1,
@@ -57,6 +52,7 @@ enum class SSLVersion: int8_t {
 
 class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
                        public TinyGsmGPRS<TinyGsmSim7600>,
+                       public TinyGsmPPP<TinyGsmSim7600>,
                        public TinyGsmTCP<TinyGsmSim7600, TINY_GSM_MUX_COUNT>,
                        public TinyGsmSMS<TinyGsmSim7600>,
                        public TinyGsmGSMLocation<TinyGsmSim7600>,
@@ -65,9 +61,11 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
                        public TinyGsmNTP<TinyGsmSim7600>,
                        public TinyGsmBattery<TinyGsmSim7600>,
                        public TinyGsmTemperature<TinyGsmSim7600>,
-                       public TinyGsmCalling<TinyGsmSim7600> {
+                       public TinyGsmCalling<TinyGsmSim7600>,
+                       public TinyGsmTransparent<TinyGsmSim7600> {
   friend class TinyGsmModem<TinyGsmSim7600>;
   friend class TinyGsmGPRS<TinyGsmSim7600>;
+  friend class TinyGsmPPP<TinyGsmSim7600>;
   friend class TinyGsmTCP<TinyGsmSim7600, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmSMS<TinyGsmSim7600>;
   friend class TinyGsmGPS<TinyGsmSim7600>;
@@ -77,6 +75,7 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
   friend class TinyGsmBattery<TinyGsmSim7600>;
   friend class TinyGsmTemperature<TinyGsmSim7600>;
   friend class TinyGsmCalling<TinyGsmSim7600>;
+  friend class TinyGsmTransparent<TinyGsmSim7600>;
 
   /*
    * Inner Client
@@ -140,7 +139,7 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     virtual int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
       at->sendAT(GF("+CIPSEND="), mux, ',', (uint16_t)len);
       if (at->waitResponse(GF(">")) != 1) { return 0; }
-      at->stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+      at->modemWritePayload(buff, len);
       at->stream.flush();
       if (at->waitResponse(GF(GSM_NL "+CIPSEND:")) != 1) { return 0; }
       at->streamSkipUntil(',');  // Skip mux
@@ -164,9 +163,9 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     //  ^^ Requested number of data bytes (1-1460 bytes)to be read
     int16_t len_confirmed = at->streamGetIntBefore('\n');
     // ^^ The data length which not read in the buffer
+#ifdef TINY_GSM_USE_HEX
     for (int i = 0; i < len_requested; i++) {
       uint32_t startMillis = millis();
-#ifdef TINY_GSM_USE_HEX
       while (stream.available() < 2 &&
              (millis() - startMillis < sockets[mux]->_timeout)) {
         TINY_GSM_YIELD();
@@ -177,15 +176,11 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
       buf[0] = stream.read();
       buf[1] = stream.read();
       char c = strtol(buf, NULL, 16);
+      at->sockets[mux]->rxPut(c);
+    }
 #else
-      while (!at->stream.available() &&
-             (millis() - startMillis < at->sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
-      char c = at->stream.read();
+    at->moveBytesFromStreamToFifo(mux, len_requested);
 #endif
-      at->sockets[mux]->rx.put(c);
-    }
     // DBG("### READ:", len_requested, "from", mux);
     // sockets[mux]->sock_available = modemGetAvailable(mux);
     at->sockets[mux]->sock_available = len_confirmed;
@@ -250,7 +245,7 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     int16_t modemSend(const void* buff, size_t len, uint8_t mux) override {
       at->sendAT(GF("+CCHSEND="), mux, ',', (uint16_t)len);
       if (at->waitResponse(GF(">")) != 1) { return 0; }
-      at->stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+      at->modemWritePayload(buff, len);
       at->stream.flush();
       if (at->waitResponse() != 1) { return 0; }
       return len;
@@ -272,10 +267,10 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
       //  ^^ Requested number of data bytes (1-1460 bytes)to be read
       int16_t len_confirmed = at->streamGetIntBefore('\n');
       // ^^ The data length which not read in the buffer
-      for (int i = 0; i < len_confirmed; i++) {
-        uint32_t startMillis = millis();
 #ifdef TINY_GSM_USE_HEX
 // (todo) Don't know how to implement this!
+      for (int i = 0; i < len_confirmed; i++) {
+        uint32_t startMillis = millis();
         while (stream.available() < 2 &&
                (millis() - startMillis < sockets[mux]->_timeout)) {
           TINY_GSM_YIELD();
@@ -286,15 +281,11 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
         buf[0] = stream.read();
         buf[1] = stream.read();
         char c = strtol(buf, NULL, 16);
+        at->sockets[mux]->rxPut(c);
+      }
 #else
-        while (!at->stream.available() &&
-               (millis() - startMillis < at->sockets[mux]->_timeout)) {
-          TINY_GSM_YIELD();
-        }
-        char c = at->stream.read();
+      at->moveBytesFromStreamToFifo(mux, len_confirmed);
 #endif
-        at->sockets[mux]->rx.put(c);
-      }
       // DBG("### READ:", len_requested, "from", mux);
       // sockets[mux]->sock_available = len_confirmed;
       String await_response = "+CCHRECV: " + String(mux) + ",0";
@@ -345,6 +336,7 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     }
 
      void stop(uint32_t maxWaitMs) override {
+      flushTx();
       at->sendAT(GF("+CCHCLOSE="), mux);
       at->waitResponse(5000L);
 
@@ -387,26 +379,22 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
 
     if (!testAT()) { return false; }
 
-    sendAT(GF("E0"));  // Echo Off
-    if (waitResponse() != 1) { return false; }
-
+    GsmConstStr setup[] = {
+        GF("E0"),  // Echo Off
 #ifdef TINY_GSM_DEBUG
-    sendAT(GF("+CMEE=2"));  // turn on verbose error codes
+        GF("+CMEE=2"),  // turn on verbose error codes
 #else
-    sendAT(GF("+CMEE=0"));  // turn off error codes
+        GF("+CMEE=0"),  // turn off error codes
 #endif
-    waitResponse();
+        GF("+CTZR=0"),  // Disable time and time zone URC's
+        GF("+CTZU=1"),  // Enable automatic time zome update
+    };
+    int8_t res[4];
+    sendATBatch(setup, 4, res, 10000L);
+    if (res[0] != 1 || res[2] != 1 || res[3] != 1) { return false; }
 
     DBG(GF("### Modem:"), getModemName());
 
-    // Disable time and time zone URC's
-    sendAT(GF("+CTZR=0"));
-    if (waitResponse(10000L) != 1) { return false; }
-
-    // Enable automatic time zome update
-    sendAT(GF("+CTZU=1"));
-    if (waitResponse(10000L) != 1) { return false; }
-
     SimStatus ret = getSimStatus();
     // if the sim isn't ready and a pin has been provided, try to unlock the sim
     if (ret != SIM_READY && pin != NULL && strlen(pin) > 0) {
@@ -423,13 +411,13 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     String name = "SIMCom SIM7600";
 
     sendAT(GF("+CGMM"));
-    String res2;
-    if (waitResponse(1000L, res2) != 1) { return name; }
-    res2.replace(GSM_NL "OK" GSM_NL, "");
-    res2.replace("_", " ");
-    res2.trim();
+    char res[TINY_GSM_RESPONSE_BUFFER];
+    if (waitResponse(1000L, res) != 1) { return name; }
+    for (char* c = res; *c; c++) {
+      if (*c == '_') { *c = ' '; }
+    }
 
-    name = res2;
+    name = cleanResponse(res);
     DBG("### Modem:", name);
     return name;
   }
@@ -446,7 +434,7 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     if (!testAT()) { return false; }
     sendAT(GF("+CRESET"));
     if (waitResponse(10000L) != 1) { return false; }
-    delay(5000L);  // TODO(?):  Test this delay!
+    waitForRestart(5000L);
     return init(pin);
   }
 
@@ -457,7 +445,7 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
 
   bool radioOffImpl() {
     if (!setPhoneFunctionality(4)) { return false; }
-    delay(3000);
+    waitForFunctionality(4, 3000L);
     return true;
   }
 
@@ -510,12 +498,9 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
   String getLocalIPImpl() {
     sendAT(GF("+IPADDR"));  // Inquire Socket PDP address
     // sendAT(GF("+CGPADDR=1"));  // Show PDP address
-    String res;
+    char res[TINY_GSM_RESPONSE_BUFFER];
     if (waitResponse(10000L, res) != 1) { return ""; }
-    res.replace(GSM_NL "OK" GSM_NL, "");
-    res.replace(GSM_NL, "");
-    res.trim();
-    return res;
+    return cleanResponse(res, '\0');
   }
 
   /*
@@ -541,16 +526,6 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     waitResponse();
 
     // Configure TCP parameters
-
-    // Select TCP/IP application mode (command mode)
-    sendAT(GF("+CIPMODE=0"));
-    waitResponse();
-
-    // Set Sending Mode - send without waiting for peer TCP ACK
-    sendAT(GF("+CIPSENDMODE=0"));
-    waitResponse();
-
-    // Configure socket parameters
     // AT+CIPCCFG= <NmRetry>, <DelayTm>, <Ack>, <errMode>, <HeaderType>,
     //            <AsyncMode>, <TimeoutVal>
     // NmRetry = number of retransmission to be made for an IP packet
@@ -564,13 +539,20 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     // AsyncMode = sets mode of executing commands
     //           = 0 (synchronous command executing)
     // TimeoutVal = minimum retransmission timeout in milliseconds = 75000
-    sendAT(GF("+CIPCCFG=10,0,0,0,1,0,75000"));
-    if (waitResponse() != 1) { return false; }
-
-    // Configure timeouts for opening and closing sockets
-    // AT+CIPTIMEOUT=<netopen_timeout> <cipopen_timeout>, <cipsend_timeout>
-    sendAT(GF("+CIPTIMEOUT="), 75000, ',', 15000, ',', 15000);
-    waitResponse();
+    GsmConstStr tcpSetup[] = {
+        // Select TCP/IP application mode (command mode)
+        GF("+CIPMODE=0"),
+        // Set Sending Mode - send without waiting for peer TCP ACK
+        GF("+CIPSENDMODE=0"),
+        // Configure socket parameters
+        GF("+CIPCCFG=10,0,0,0,1,0,75000"),
+        // Configure timeouts for opening and closing sockets
+        // AT+CIPTIMEOUT=<netopen_timeout> <cipopen_timeout>, <cipsend_timeout>
+        GF("+CIPTIMEOUT=75000,15000,15000"),
+    };
+    int8_t res[4];
+    sendATBatch(tcpSetup, 4, res);
+    if (res[2] != 1) { return false; }
 
     // Start the socket service
 
@@ -605,6 +587,22 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     return (waitResponse(60000L, GF(GSM_NL "+CCHSTOP: 0")) != 1);
   }
 
+  // Stops the socket service and starts it again in multi-socket mode or in
+  // the single connection mode transparent transmission needs, which can only
+  // be chosen while it is stopped.  This closes every open connection.
+  bool restartNetwork(bool transparent) {
+    sendAT(GF("+NETCLOSE"));
+    waitResponse(60000L, GF(GSM_NL "+NETCLOSE:"));
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      if (sockets[mux]) { sockets[mux]->sock_connected = false; }
+    }
+    forgetSetting(SETTING_CIPRXGET);
+    sendAT(GF("+CIPMODE="), transparent ? 1 : 0);
+    if (waitResponse() != 1) { return false; }
+    sendAT(GF("+NETOPEN"));
+    return waitResponse(75000L, GF(GSM_NL "+NETOPEN: 0")) == 1;
+  }
+
   bool isGprsConnectedImpl() {
     sendAT(GF("+NETOPEN?"));
     // May return +NETOPEN: 1, 0.  We just confirm that the first number is 1
@@ -618,6 +616,45 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     return true;
   }
 
+  /*
+   * Transparent mode functions
+   */
+ protected:
+  bool transparentConnectImpl(const char* host, uint16_t port, uint8_t,
+                              int timeout_s) {
+    uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
+    // Transparent transmission only works with a single connection, so this
+    // closes the other clients' connections
+    if (!restartNetwork(true)) { return false; }
+    sendAT(GF("+CIPOPEN=0,\"TCP\",\""), host, GF("\","), port);
+    // The reply is CONNECT, possibly with the baud rate, or CONNECT FAIL
+    if (waitResponse(timeout_ms, GF(GSM_NL "CONNECT"), GFP(GSM_ERROR),
+                     GF(GSM_NL "+CIPOPEN:")) == 1) {
+      char rest[16];
+      streamGetStringBefore('\n', rest, sizeof(rest));
+      if (!strstr(rest, "FAIL")) { return true; }  // The data follows
+    }
+    restartNetwork(false);
+    return false;
+  }
+
+  void transparentStopImpl(uint8_t, uint32_t maxWaitMs) {
+    sendAT(GF("+CIPCLOSE=0"));
+    waitResponse(maxWaitMs, GF(GSM_NL "+CIPCLOSE:"), GFP(GSM_ERROR));
+    // Back to the multi-socket mode used by the other clients
+    restartNetwork(false);
+  }
+
+  bool resumeDataModeImpl() {
+    sendAT(GF("O"));
+    if (waitResponse(GF(GSM_NL "CONNECT"), GFP(GSM_ERROR)) != 1) {
+      return false;
+    }
+    streamSkipUntil('\n');
+    dataMode = true;
+    return true;
+  }
+
   /*
    * SIM card functions
    */
@@ -921,8 +958,9 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
     }
 
     // Make sure we'll be getting data manually on this connection
-    sendAT(GF("+CIPRXGET=1"));
-    if (waitResponse() != 1) { return false; }
+    if (!sendATCached(SETTING_CIPRXGET, 1, 1000L, GF("+CIPRXGET=1"))) {
+      return false;
+    }
 
     // Establish a connection in multi-socket mode
     uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
@@ -985,128 +1023,58 @@ class TinyGsmSim7600 : public TinyGsmModem<TinyGsmSim7600>,
   }
 
   /*
-   * Utilities
+   * URC handlers
    */
- public:
-  // TODO(vshymanskyy): Optimize this!
-  int8_t waitResponse(uint32_t timeout_ms, String& data,
-                      GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s);*/
-    data.reserve(64);
-    uint8_t  index       = 0;
-    uint32_t startMillis = millis();
-    do {
-      TINY_GSM_YIELD();
-      while (stream.available() > 0) {
-        TINY_GSM_YIELD();
-        int8_t a = stream.read();
-        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
-#if defined TINY_GSM_DEBUG
-          if (r3 == GFP(GSM_CME_ERROR)) {
-            streamSkipUntil('\n');  // Read out the error
-          }
-#endif
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
-          goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (data.endsWith(GF(GSM_NL "+CIPRXGET:"))) {
-          int8_t mode = streamGetIntBefore(',');
-          if (mode == 1) {
-            int8_t mux = streamGetIntBefore('\n');
-            if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-              sockets[mux]->got_data = true;
-            }
-            data = "";
-            // DBG("### Got Data:", mux);
-          } else {
-            data += mode;
-          }
-        } else if (data.endsWith(GF(GSM_NL "+RECEIVE:"))) {
-          int8_t  mux = streamGetIntBefore(',');
-          int16_t len = streamGetIntBefore('\n');
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->got_data = true;
-            if (len >= 0 && len <= 1024) { sockets[mux]->sock_available = len; }
-          }
-          data = "";
-          // DBG("### Got Data:", len, "on", mux);
-        } else if (data.endsWith(GF("+IPCLOSE:"))) {
-          int8_t mux = streamGetIntBefore(',');
-          streamSkipUntil('\n');  // Skip the reason code
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->sock_connected = false;
-          }
-          data = "";
-          DBG("### Closed: ", mux);
-        } else if (data.endsWith(GF("+CIPEVENT:"))) {
-          // Need to close all open sockets and release the network library.
-          // User will then need to reconnect.
-          DBG("### Network error!");
-          if (!isGprsConnected()) { gprsDisconnect(); }
-          data = "";
-        }
-      }
-    } while (millis() - startMillis < timeout_ms);
-  finish:
-    if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
+ protected:
+  bool handleRxGet() {
+    int8_t mode = streamGetIntBefore(',');
+    if (mode != 1) { return false; }
+    int8_t mux = streamGetIntBefore('\n');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->got_data = true;
     }
-    // data.replace(GSM_NL, "/");
-    // DBG('<', index, '>', data);
-    return index;
+    // DBG("### Got Data:", mux);
+    return true;
   }
 
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+  bool handleReceive() {
+    int8_t  mux = streamGetIntBefore(',');
+    int16_t len = streamGetIntBefore('\n');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->got_data = true;
+      if (len >= 0 && len <= 1024) { sockets[mux]->sock_available = len; }
+    }
+    // DBG("### Got Data:", len, "on", mux);
+    return true;
   }
 
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    return waitResponse(1000, r1, r2, r3, r4, r5);
+  bool handleClosed() {
+    int8_t mux = streamGetIntBefore(',');
+    streamSkipUntil('\n');  // Skip the reason code
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->sock_connected = false;
+    }
+    DBG("### Closed: ", mux);
+    return true;
+  }
+
+  bool handleNetworkError() {
+    // Need to close all open sockets and release the network library.
+    // User will then need to reconnect.
+    DBG("### Network error!");
+    if (!isGprsConnected()) { gprsDisconnect(); }
+    return true;
+  }
+
+  const TinyGsmUrc<TinyGsmSim7600>* urcTable(uint8_t& count) {
+    static constexpr TinyGsmUrc<TinyGsmSim7600> urcs[] TINY_GSM_PROGMEM = {
+        {GSM_NL "+CIPRXGET:", &TinyGsmSim7600::handleRxGet},
+        {GSM_NL "+RECEIVE:", &TinyGsmSim7600::handleReceive},
+        {"+IPCLOSE:", &TinyGsmSim7600::handleClosed},
+        {"+CIPEVENT:", &TinyGsmSim7600::handleNetworkError},
+    };
+    count = sizeof(urcs) / sizeof(urcs[0]);
+    return urcs;
   }
 
  public:
@@ -15,10 +15,21 @@
 
 #define TINY_GSM_MUX_COUNT 5
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+// +CIPSEND takes at most 1460 bytes at a time
+#define TINY_GSM_MAX_SEND 1460
+
+// How many sends may be waiting for their DATA ACCEPT on each socket.  With
+// 0 every send waits for its own acknowledgement, otherwise the quick send
+// acknowledgements are picked up as URC's and a send only waits when the
+// window is full.
+#if !defined(TINY_GSM_SEND_WINDOW)
+#define TINY_GSM_SEND_WINDOW 0
+#endif
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmCalling.tpp"
 #include "TinyGsmGPRS.tpp"
+#include "TinyGsmPPP.tpp"
 #include "TinyGsmGSMLocation.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
@@ -26,14 +37,7 @@
 #include "TinyGsmTCP.tpp"
 #include "TinyGsmTime.tpp"
 #include "TinyGsmNTP.tpp"
-
-#define GSM_NL "\r\n"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
-#if defined       TINY_GSM_DEBUG
-static const char GSM_CME_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CME ERROR:";
-static const char GSM_CMS_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CMS ERROR:";
-#endif
+#include "TinyGsmTransparent.tpp"
 
 enum RegStatus {
   REG_NO_RESULT    = -1,
@@ -46,6 +50,7 @@ enum RegStatus {
 };
 class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
                       public TinyGsmGPRS<TinyGsmSim800>,
+                      public TinyGsmPPP<TinyGsmSim800>,
                       public TinyGsmTCP<TinyGsmSim800, TINY_GSM_MUX_COUNT>,
                       public TinyGsmSSL<TinyGsmSim800>,
                       public TinyGsmCalling<TinyGsmSim800>,
@@ -53,9 +58,11 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
                       public TinyGsmGSMLocation<TinyGsmSim800>,
                       public TinyGsmTime<TinyGsmSim800>,
                       public TinyGsmNTP<TinyGsmSim800>,
-                      public TinyGsmBattery<TinyGsmSim800> {
+                      public TinyGsmBattery<TinyGsmSim800>,
+                      public TinyGsmTransparent<TinyGsmSim800> {
   friend class TinyGsmModem<TinyGsmSim800>;
   friend class TinyGsmGPRS<TinyGsmSim800>;
+  friend class TinyGsmPPP<TinyGsmSim800>;
   friend class TinyGsmTCP<TinyGsmSim800, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmSSL<TinyGsmSim800>;
   friend class TinyGsmCalling<TinyGsmSim800>;
@@ -63,6 +70,7 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
   friend class TinyGsmGSMLocation<TinyGsmSim800>;
   friend class TinyGsmTime<TinyGsmSim800>;
   friend class TinyGsmNTP<TinyGsmSim800>;
+  friend class TinyGsmTransparent<TinyGsmSim800>;
   friend class TinyGsmBattery<TinyGsmSim800>;
 
   /*
@@ -85,6 +93,7 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
       prev_check     = 0;
       sock_connected = false;
       got_data       = false;
+      sends_pending  = 0;
 
       if (mux < TINY_GSM_MUX_COUNT) {
         this->mux = mux;
@@ -101,6 +110,7 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
       stop();
       TINY_GSM_YIELD();
       rx.clear();
+      sends_pending  = 0;
       sock_connected = at->modemConnect(host, port, mux, false, timeout_s);
       return sock_connected;
     }
@@ -121,6 +131,9 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
      */
 
     String remoteIP() TINY_GSM_ATTR_NOT_IMPLEMENTED;
+
+   protected:
+    uint8_t sends_pending;  // Sends not yet acknowledged with DATA ACCEPT
   };
 
   /*
@@ -166,26 +179,22 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     // sendAT(GF("&FZ"));  // Factory + Reset
     // waitResponse();
 
-    sendAT(GF("E0"));  // Echo Off
-    if (waitResponse() != 1) { return false; }
-
+    GsmConstStr setup[] = {
+        GF("E0"),  // Echo Off
 #ifdef TINY_GSM_DEBUG
-    sendAT(GF("+CMEE=2"));  // turn on verbose error codes
+        GF("+CMEE=2"),  // turn on verbose error codes
 #else
-    sendAT(GF("+CMEE=0"));  // turn off error codes
+        GF("+CMEE=0"),  // turn off error codes
 #endif
-    waitResponse();
+        GF("+CLTS=1"),     // Enable Local Time Stamp for getting network time
+        GF("+CBATCHK=1"),  // Enable battery checks
+    };
+    int8_t res[4];
+    sendATBatch(setup, 4, res, 10000L);
+    if (res[0] != 1 || res[2] != 1) { return false; }
 
     DBG(GF("### Modem:"), getModemName());
 
-    // Enable Local Time Stamp for getting network time
-    sendAT(GF("+CLTS=1"));
-    if (waitResponse(10000L) != 1) { return false; }
-
-    // Enable battery checks
-    sendAT(GF("+CBATCHK=1"));
-    waitResponse();
-
     SimStatus ret = getSimStatus();
     // if the sim isn't ready and a pin has been provided, try to unlock the sim
     if (ret != SIM_READY && pin != NULL && strlen(pin) > 0) {
@@ -211,13 +220,13 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
 #endif
 
     sendAT(GF("+GMM"));
-    String res2;
-    if (waitResponse(1000L, res2) != 1) { return name; }
-    res2.replace(GSM_NL "OK" GSM_NL, "");
-    res2.replace("_", " ");
-    res2.trim();
+    char res[TINY_GSM_RESPONSE_BUFFER];
+    if (waitResponse(1000L, res) != 1) { return name; }
+    for (char* c = res; *c; c++) {
+      if (*c == '_') { *c = ' '; }
+    }
 
-    name = res2;
+    name = cleanResponse(res);
     DBG("### Modem:", name);
     return name;
   }
@@ -259,7 +268,7 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     waitResponse();
     if (!setPhoneFunctionality(0)) { return false; }
     if (!setPhoneFunctionality(1, true)) { return false; }
-    delay(3000);
+    waitForRestart(3000L);
     return init(pin);
   }
 
@@ -302,12 +311,9 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
 
   String getLocalIPImpl() {
     sendAT(GF("+CIFSR;E0"));
-    String res;
+    char res[TINY_GSM_RESPONSE_BUFFER];
     if (waitResponse(10000L, res) != 1) { return ""; }
-    res.replace(GSM_NL "OK" GSM_NL, "");
-    res.replace(GSM_NL, "");
-    res.trim();
-    return res;
+    return cleanResponse(res, '\0');
   }
 
   /*
@@ -357,20 +363,37 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     sendAT(GF("+CGATT=1"));
     if (waitResponse(60000L) != 1) { return false; }
 
-    // Set to multi-IP
-    sendAT(GF("+CIPMUX=1"));
-    if (waitResponse() != 1) { return false; }
-
-    // Put in "quick send" mode (thus no extra "Send OK")
-    sendAT(GF("+CIPQSEND=1"));
-    if (waitResponse() != 1) { return false; }
+    // Start Task and Set APN, USER NAME, PASSWORD
+    return startTcpStack(false, GF("\""), apn, GF("\",\""), user, GF("\",\""),
+                         pwd, GF("\""));
+  }
 
-    // Set to get data manually
-    sendAT(GF("+CIPRXGET=1"));
-    if (waitResponse() != 1) { return false; }
+  // Brings up the TCP/IP stack, in multi-IP mode or in the single connection
+  // mode transparent transmission needs.  Both can only be chosen before
+  // +CSTT, whose parameters are given as cstt.
+  template <typename... Args>
+  bool startTcpStack(bool transparent, Args... cstt) {
+    GsmConstStr tcpSetup[] = {
+        GF("+CIPMUX=1"),  // Set to multi-IP
+        GF("+CIPMODE=0"),
+        // Put in "quick send" mode (thus no extra "Send OK")
+        GF("+CIPQSEND=1"),
+        GF("+CIPRXGET=1"),  // Set to get data manually
+    };
+    GsmConstStr transparentSetup[] = {
+        GF("+CIPMUX=0"),  // Transparent mode only has a single connection
+        GF("+CIPMODE=1"),
+        GF("+CIPRXGET=0"),  // The data comes straight over the serial port
+    };
+    if (transparent) {
+      if (sendATBatch(transparentSetup, 3, NULL, 1000L, true) != 3) {
+        return false;
+      }
+    } else if (sendATBatch(tcpSetup, 4, NULL, 1000L, true) != 4) {
+      return false;
+    }
 
-    // Start Task and Set APN, USER NAME, PASSWORD
-    sendAT(GF("+CSTT=\""), apn, GF("\",\""), user, GF("\",\""), pwd, GF("\""));
+    sendAT(GF("+CSTT="), cstt...);
     if (waitResponse(60000L) != 1) { return false; }
 
     // Bring Up Wireless Connection with GPRS or CSD
@@ -388,6 +411,23 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     return true;
   }
 
+  // Shuts the TCP/IP stack down and brings it back up in the other mode,
+  // with the APN it had.  This closes every open connection.
+  bool restartTcpStack(bool transparent) {
+    sendAT(GF("+CSTT?"));
+    if (waitResponse(GF("+CSTT: ")) != 1) { return false; }
+    char cstt[TINY_GSM_RESPONSE_BUFFER];
+    streamGetStringBefore('\n', cstt, sizeof(cstt));
+    waitResponse();
+
+    sendAT(GF("+CIPSHUT"));
+    if (waitResponse(60000L, GF("SHUT OK")) != 1) { return false; }
+    for (int mux = 0; mux < TINY_GSM_MUX_COUNT; mux++) {
+      if (sockets[mux]) { sockets[mux]->sock_connected = false; }
+    }
+    return startTcpStack(transparent, cleanResponse(cstt));
+  }
+
   bool gprsDisconnectImpl() {
     // Shut the TCP/IP connection
     // CIPSHUT will close *all* open connections
@@ -400,6 +440,44 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     return true;
   }
 
+  /*
+   * Transparent mode functions
+   */
+ protected:
+  bool transparentConnectImpl(const char* host, uint16_t port, uint8_t,
+                              int timeout_s) {
+    uint32_t timeout_ms = ((uint32_t)timeout_s) * 1000;
+    // Transparent transmission only works with a single connection, so this
+    // closes the other clients' connections
+    if (!restartTcpStack(true)) { return false; }
+    sendAT(GF("+CIPSTART=\"TCP\",\""), host, GF("\","), port);
+    // The reply is OK, then CONNECT or CONNECT FAIL
+    if (waitResponse(timeout_ms, GF(GSM_NL "CONNECT"), GFP(GSM_ERROR)) == 1) {
+      char rest[16];
+      streamGetStringBefore('\n', rest, sizeof(rest));
+      if (!strstr(rest, "FAIL")) { return true; }  // The data follows
+    }
+    restartTcpStack(false);
+    return false;
+  }
+
+  void transparentStopImpl(uint8_t, uint32_t maxWaitMs) {
+    sendAT(GF("+CIPCLOSE"));
+    waitResponse(maxWaitMs, GF("CLOSE OK"), GFP(GSM_ERROR));
+    // Back to the multi-IP mode used by the other clients
+    restartTcpStack(false);
+  }
+
+  bool resumeDataModeImpl() {
+    sendAT(GF("O"));
+    if (waitResponse(GF(GSM_NL "CONNECT"), GFP(GSM_ERROR)) != 1) {
+      return false;
+    }
+    streamSkipUntil('\n');
+    dataMode = true;
+    return true;
+  }
+
   /*
    * SIM card functions
    */
@@ -541,14 +619,39 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
   }
 
   int16_t modemSend(const void* buff, size_t len, uint8_t mux) {
+#if TINY_GSM_SEND_WINDOW > 0
+    if (!waitSendWindow(mux, 1000L)) { return 0; }
+#endif
     sendAT(GF("+CIPSEND="), mux, ',', (uint16_t)len);
     if (waitResponse(GF(">")) != 1) { return 0; }
-    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    modemWritePayload(buff, len);
     stream.flush();
+#if TINY_GSM_SEND_WINDOW > 0
+    // The DATA ACCEPT is picked up later by handleDataAccept
+    sockets[mux]->sends_pending++;
+    return len;
+#else
     if (waitResponse(GF(GSM_NL "DATA ACCEPT:")) != 1) { return 0; }
     streamSkipUntil(',');  // Skip mux
     return streamGetIntBefore('\n');
+#endif
+  }
+
+#if TINY_GSM_SEND_WINDOW > 0
+  // Handles URC's until the socket has room for another send in its window
+  bool waitSendWindow(uint8_t mux, uint32_t timeout_ms) {
+    GsmClientSim800* sock        = sockets[mux];
+    uint32_t         startMillis = millis();
+    while (sock->sends_pending >= TINY_GSM_SEND_WINDOW) {
+      if (!sock->sock_connected || millis() - startMillis >= timeout_ms) {
+        return false;
+      }
+      poll(1);  // Stop reading as soon as an acknowledgement is handled
+      TINY_GSM_YIELD();
+    }
+    return true;
   }
+#endif
 
   size_t modemRead(size_t size, uint8_t mux) {
     if (!sockets[mux]) return 0;
@@ -569,9 +672,9 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     // SRGD NOTE:  Contrary to above (which is copied from AT command manual)
     // this is actually be the number of bytes that will be remaining in the
     // buffer after the read.
+#ifdef TINY_GSM_USE_HEX
     for (int i = 0; i < len_requested; i++) {
       uint32_t startMillis = millis();
-#ifdef TINY_GSM_USE_HEX
       while (stream.available() < 2 &&
              (millis() - startMillis < sockets[mux]->_timeout)) {
         TINY_GSM_YIELD();
@@ -582,15 +685,11 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
       buf[0] = stream.read();
       buf[1] = stream.read();
       char c = strtol(buf, NULL, 16);
+      sockets[mux]->rxPut(c);
+    }
 #else
-      while (!stream.available() &&
-             (millis() - startMillis < sockets[mux]->_timeout)) {
-        TINY_GSM_YIELD();
-      }
-      char c = stream.read();
+    moveBytesFromStreamToFifo(mux, len_requested);
 #endif
-      sockets[mux]->rx.put(c);
-    }
     // DBG("### READ:", len_requested, "from", mux);
     // sockets[mux]->sock_available = modemGetAvailable(mux);
     sockets[mux]->sock_available = len_confirmed;
@@ -613,6 +712,28 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
     return result;
   }
 
+  int16_t modemGetPendingTx(uint8_t mux) {
+    sendAT(GF("+CIPACK="), mux);
+    if (waitResponse(GF("+CIPACK:")) != 1) { return -1; }
+    streamSkipUntil(',');  // Skip total sent
+    streamSkipUntil(',');  // Skip acknowledged
+    int16_t result = streamGetIntBefore('\n');
+    waitResponse();
+    return result;
+  }
+
+  int16_t modemGetTxFree(uint8_t mux) {
+    // Gives one "+CIPSEND: <mux>,<size>" line for each connection
+    sendAT(GF("+CIPSEND?"));
+    int16_t result = -1;
+    while (waitResponse(GF("+CIPSEND:"), GFP(GSM_OK), GFP(GSM_ERROR)) == 1) {
+      int8_t  sock = streamGetIntBefore(',');
+      int16_t size = streamGetIntBefore('\n');
+      if (sock == mux) { result = size; }
+    }
+    return result;
+  }
+
   bool modemGetConnected(uint8_t mux) {
     sendAT(GF("+CIPSTATUS="), mux);
     waitResponse(GF("+CIPSTATUS"));
@@ -624,140 +745,93 @@ class TinyGsmSim800 : public TinyGsmModem<TinyGsmSim800>,
   }
 
   /*
-   * Utilities
+   * URC handlers
    */
- public:
-  // TODO(vshymanskyy): Optimize this!
-  int8_t waitResponse(uint32_t timeout_ms, String& data,
-                      GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s);*/
-    data.reserve(64);
-    uint8_t  index       = 0;
-    uint32_t startMillis = millis();
-    do {
-      TINY_GSM_YIELD();
-      while (stream.available() > 0) {
-        TINY_GSM_YIELD();
-        int8_t a = stream.read();
-        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
-#if defined TINY_GSM_DEBUG
-          if (r3 == GFP(GSM_CME_ERROR)) {
-            streamSkipUntil('\n');  // Read out the error
-          }
-#endif
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
-          goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (data.endsWith(GF(GSM_NL "+CIPRXGET:"))) {
-          int8_t mode = streamGetIntBefore(',');
-          if (mode == 1) {
-            int8_t mux = streamGetIntBefore('\n');
-            if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-              sockets[mux]->got_data = true;
-            }
-            data = "";
-            // DBG("### Got Data:", mux);
-          } else {
-            data += mode;
-          }
-        } else if (data.endsWith(GF(GSM_NL "+RECEIVE:"))) {
-          int8_t  mux = streamGetIntBefore(',');
-          int16_t len = streamGetIntBefore('\n');
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->got_data = true;
-            if (len >= 0 && len <= 1024) { sockets[mux]->sock_available = len; }
-          }
-          data = "";
-          // DBG("### Got Data:", len, "on", mux);
-        } else if (data.endsWith(GF("CLOSED" GSM_NL))) {
-          int8_t nl   = data.lastIndexOf(GSM_NL, data.length() - 8);
-          int8_t coma = data.indexOf(',', nl + 2);
-          int8_t mux  = data.substring(nl + 2, coma).toInt();
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->sock_connected = false;
-          }
-          data = "";
-          DBG("### Closed: ", mux);
-        } else if (data.endsWith(GF("*PSNWID:"))) {
-          streamSkipUntil('\n');  // Refresh network name by network
-          data = "";
-          DBG("### Network name updated.");
-        } else if (data.endsWith(GF("*PSUTTZ:"))) {
-          streamSkipUntil('\n');  // Refresh time and time zone by network
-          data = "";
-          DBG("### Network time and time zone updated.");
-        } else if (data.endsWith(GF("+CTZV:"))) {
-          streamSkipUntil('\n');  // Refresh network time zone by network
-          data = "";
-          DBG("### Network time zone updated.");
-        } else if (data.endsWith(GF("DST:"))) {
-          streamSkipUntil(
-              '\n');  // Refresh Network Daylight Saving Time by network
-          data = "";
-          DBG("### Daylight savings time state updated.");
-        }
-      }
-    } while (millis() - startMillis < timeout_ms);
-  finish:
-    if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
+ protected:
+  bool handleRxGet() {
+    int8_t mode = streamGetIntBefore(',');
+    if (mode != 1) { return false; }
+    int8_t mux = streamGetIntBefore('\n');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->got_data = true;
     }
-    // data.replace(GSM_NL, "/");
-    // DBG('<', index, '>', data);
-    return index;
+    // DBG("### Got Data:", mux);
+    return true;
   }
 
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
+  bool handleReceive() {
+    int8_t  mux = streamGetIntBefore(',');
+    int16_t len = streamGetIntBefore('\n');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->got_data = true;
+      if (len >= 0 && len <= 1024) { sockets[mux]->sock_available = len; }
+    }
+    // DBG("### Got Data:", len, "on", mux);
+    return true;
+  }
+
+  bool handleClosed() {
+    int8_t mux = matcher.lineInt();  // "<mux>, CLOSED"
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->sock_connected = false;
+      sockets[mux]->sends_pending  = 0;
+    }
+    DBG("### Closed: ", mux);
+    return true;
+  }
+
+#if TINY_GSM_SEND_WINDOW > 0
+  bool handleDataAccept() {
+    int8_t mux = streamGetIntBefore(',');
+    streamSkipUntil('\n');  // Skip the length accepted
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux] &&
+        sockets[mux]->sends_pending) {
+      sockets[mux]->sends_pending--;
+    }
+    return true;
+  }
 #endif
-                      GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+
+  bool handleNetworkName() {
+    streamSkipUntil('\n');  // Refresh network name by network
+    DBG("### Network name updated.");
+    return true;
   }
 
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
+  bool handleNetworkTime() {
+    streamSkipUntil('\n');  // Refresh time and time zone by network
+    DBG("### Network time and time zone updated.");
+    return true;
+  }
+
+  bool handleTimeZone() {
+    streamSkipUntil('\n');  // Refresh network time zone by network
+    DBG("### Network time zone updated.");
+    return true;
+  }
+
+  bool handleDaylightSaving() {
+    streamSkipUntil('\n');  // Refresh Network Daylight Saving Time by network
+    DBG("### Daylight savings time state updated.");
+    return true;
+  }
+
+  const TinyGsmUrc<TinyGsmSim800>* urcTable(uint8_t& count) {
+    static constexpr TinyGsmUrc<TinyGsmSim800> urcs[] TINY_GSM_PROGMEM = {
+        {GSM_NL "+CIPRXGET:", &TinyGsmSim800::handleRxGet},
+        {GSM_NL "+RECEIVE:", &TinyGsmSim800::handleReceive},
+        {"CLOSED" GSM_NL, &TinyGsmSim800::handleClosed},
+#if TINY_GSM_SEND_WINDOW > 0
+        // Otherwise modemSend waits for it itself
+        {"DATA ACCEPT:", &TinyGsmSim800::handleDataAccept},
 #endif
-                      GsmConstStr r5 = NULL) {
-    return waitResponse(1000, r1, r2, r3, r4, r5);
+        {"*PSNWID:", &TinyGsmSim800::handleNetworkName},
+        {"*PSUTTZ:", &TinyGsmSim800::handleNetworkTime},
+        {"+CTZV:", &TinyGsmSim800::handleTimeZone},
+        {"DST:", &TinyGsmSim800::handleDaylightSaving},
+    };
+    count = sizeof(urcs) / sizeof(urcs[0]);
+    return urcs;
   }
 
  public:
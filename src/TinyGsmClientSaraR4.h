@@ -14,9 +14,13 @@
 
 #define TINY_GSM_MUX_COUNT 7
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+// +USORD and +USOWR handle at most 1024 bytes at a time
+#define TINY_GSM_MAX_READ 1024
+#define TINY_GSM_MAX_SEND 1024
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmGPRS.tpp"
+#include "TinyGsmPPP.tpp"
 #include "TinyGsmGPS.tpp"
 #include "TinyGsmGSMLocation.tpp"
 #include "TinyGsmModem.tpp"
@@ -26,14 +30,6 @@
 #include "TinyGsmTemperature.tpp"
 #include "TinyGsmTime.tpp"
 
-#define GSM_NL "\r\n"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
-#if defined       TINY_GSM_DEBUG
-static const char GSM_CME_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CME ERROR:";
-static const char GSM_CMS_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CMS ERROR:";
-#endif
-
 enum RegStatus {
   REG_NO_RESULT    = -1,
   REG_UNREGISTERED = 0,
@@ -46,6 +42,7 @@ enum RegStatus {
 
 class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
                       public TinyGsmGPRS<TinyGsmSaraR4>,
+                      public TinyGsmPPP<TinyGsmSaraR4>,
                       public TinyGsmTCP<TinyGsmSaraR4, TINY_GSM_MUX_COUNT>,
                       public TinyGsmSSL<TinyGsmSaraR4>,
                       public TinyGsmBattery<TinyGsmSaraR4>,
@@ -56,6 +53,7 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
                       public TinyGsmTime<TinyGsmSaraR4> {
   friend class TinyGsmModem<TinyGsmSaraR4>;
   friend class TinyGsmGPRS<TinyGsmSaraR4>;
+  friend class TinyGsmPPP<TinyGsmSaraR4>;
   friend class TinyGsmTCP<TinyGsmSaraR4, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmSSL<TinyGsmSaraR4>;
   friend class TinyGsmBattery<TinyGsmSaraR4>;
@@ -265,19 +263,15 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
 
   // only difference in implementation is the warning on the wrong type
   String getModemNameImpl() {
+    char res[TINY_GSM_RESPONSE_BUFFER];
     sendAT(GF("+CGMI"));
-    String res1;
-    if (waitResponse(1000L, res1) != 1) { return "u-blox Cellular Modem"; }
-    res1.replace(GSM_NL "OK" GSM_NL, "");
-    res1.trim();
+    if (waitResponse(1000L, res) != 1) { return "u-blox Cellular Modem"; }
+    String name = cleanResponse(res);
 
     sendAT(GF("+GMM"));
-    String res2;
-    if (waitResponse(1000L, res2) != 1) { return "u-blox Cellular Modem"; }
-    res2.replace(GSM_NL "OK" GSM_NL, "");
-    res2.trim();
-
-    String name = res1 + String(' ') + res2;
+    if (waitResponse(1000L, res) != 1) { return "u-blox Cellular Modem"; }
+    name += ' ';
+    name += cleanResponse(res);
     DBG("### Modem:", name);
     if (!name.startsWith("u-blox SARA-R4") &&
         !name.startsWith("u-blox SARA-N4")) {
@@ -300,7 +294,7 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
   bool restartImpl(const char* pin = NULL) {
     if (!testAT()) { return false; }
     if (!setPhoneFunctionality(15)) { return false; }
-    delay(3000);  // TODO(?):  Verify delay timing here
+    waitForRestart(3000L);
     return init(pin);
   }
 
@@ -702,7 +696,7 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
     if (waitResponse(GF("@")) != 1) { return 0; }
     // 50ms delay, see AT manual section 25.10.4
     delay(50);
-    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    modemWritePayload(buff, len);
     stream.flush();
     if (waitResponse(GF(GSM_NL "+USOWR:")) != 1) { return 0; }
     streamSkipUntil(',');  // Skip mux
@@ -746,6 +740,17 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
     return result;
   }
 
+  int16_t modemGetPendingTx(uint8_t mux) {
+    // Parameter 11 is the number of bytes not yet acknowledged
+    sendAT(GF("+USOCTL="), mux, GF(",11"));
+    if (waitResponse(GF(GSM_NL "+USOCTL:")) != 1) { return -1; }
+    streamSkipUntil(',');  // Skip mux
+    streamSkipUntil(',');  // Skip type
+    int16_t result = streamGetIntBefore('\n');
+    waitResponse();
+    return result;
+  }
+
   bool modemGetConnected(uint8_t mux) {
     // NOTE:  Querying a closed socket gives an error "operation not allowed"
     sendAT(GF("+USOCTL="), mux, ",10");
@@ -772,119 +777,49 @@ class TinyGsmSaraR4 : public TinyGsmModem<TinyGsmSaraR4>,
   }
 
   /*
-   * Utilities
+   * URC handlers
    */
- public:
-  // TODO(vshymanskyy): Optimize this!
-  int8_t waitResponse(uint32_t timeout_ms, String& data,
-                      GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s);*/
-    data.reserve(64);
-    uint8_t  index       = 0;
-    uint32_t startMillis = millis();
-    do {
-      TINY_GSM_YIELD();
-      while (stream.available() > 0) {
-        TINY_GSM_YIELD();
-        int8_t a = stream.read();
-        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
-#if defined TINY_GSM_DEBUG
-          if (r3 == GFP(GSM_CME_ERROR)) {
-            streamSkipUntil('\n');  // Read out the error
-          }
-#endif
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
-          goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (data.endsWith(GF("+UUSORD:"))) {
-          int8_t  mux = streamGetIntBefore(',');
-          int16_t len = streamGetIntBefore('\n');
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->got_data = true;
-            // max size is 1024
-            if (len >= 0 && len <= 1024) { sockets[mux]->sock_available = len; }
-          }
-          data = "";
-          DBG("### URC Data Received:", len, "on", mux);
-        } else if (data.endsWith(GF("+UUSOCL:"))) {
-          int8_t mux = streamGetIntBefore('\n');
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
-            sockets[mux]->sock_connected = false;
-          }
-          data = "";
-          DBG("### URC Sock Closed: ", mux);
-        } else if (data.endsWith(GF("+UUSOCO:"))) {
-          int8_t mux          = streamGetIntBefore('\n');
-          int8_t socket_error = streamGetIntBefore('\n');
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux] &&
-              socket_error == 0) {
-            sockets[mux]->sock_connected = true;
-          }
-          data = "";
-          DBG("### URC Sock Opened: ", mux);
-        }
-      }
-    } while (millis() - startMillis < timeout_ms);
-  finish:
-    if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
+ protected:
+  bool handleReceive() {
+    int8_t  mux = streamGetIntBefore(',');
+    int16_t len = streamGetIntBefore('\n');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->got_data = true;
+      // max size is 1024
+      if (len >= 0 && len <= 1024) { sockets[mux]->sock_available = len; }
     }
-    // data.replace(GSM_NL, "/");
-    // DBG('<', index, '>', data);
-    return index;
+    DBG("### URC Data Received:", len, "on", mux);
+    return true;
   }
 
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+  bool handleClosed() {
+    int8_t mux = streamGetIntBefore('\n');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux]) {
+      sockets[mux]->sock_connected = false;
+    }
+    DBG("### URC Sock Closed: ", mux);
+    return true;
   }
 
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    return waitResponse(1000, r1, r2, r3, r4, r5);
+  bool handleOpened() {
+    int8_t mux          = streamGetIntBefore('\n');
+    int8_t socket_error = streamGetIntBefore('\n');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT && sockets[mux] &&
+        socket_error == 0) {
+      sockets[mux]->sock_connected = true;
+    }
+    DBG("### URC Sock Opened: ", mux);
+    return true;
+  }
+
+  const TinyGsmUrc<TinyGsmSaraR4>* urcTable(uint8_t& count) {
+    static constexpr TinyGsmUrc<TinyGsmSaraR4> urcs[] TINY_GSM_PROGMEM = {
+        {"+UUSORD:", &TinyGsmSaraR4::handleReceive},
+        {"+UUSOCL:", &TinyGsmSaraR4::handleClosed},
+        {"+UUSOCO:", &TinyGsmSaraR4::handleOpened},
+    };
+    count = sizeof(urcs) / sizeof(urcs[0]);
+    return urcs;
   }
 
  public:
@@ -13,9 +13,12 @@
 
 #define TINY_GSM_MUX_COUNT 6
 #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
+// +SQNSSENDEXT takes at most 1500 bytes at a time
+#define TINY_GSM_MAX_SEND 1500
 
 #include "TinyGsmCalling.tpp"
 #include "TinyGsmGPRS.tpp"
+#include "TinyGsmPPP.tpp"
 #include "TinyGsmModem.tpp"
 #include "TinyGsmSMS.tpp"
 #include "TinyGsmSSL.tpp"
@@ -23,14 +26,6 @@
 #include "TinyGsmTemperature.tpp"
 #include "TinyGsmTime.tpp"
 
-#define GSM_NL "\r\n"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
-#if defined       TINY_GSM_DEBUG
-static const char GSM_CME_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CME ERROR:";
-static const char GSM_CMS_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CMS ERROR:";
-#endif
-
 enum RegStatus {
   REG_NO_RESULT    = -1,
   REG_UNREGISTERED = 0,
@@ -54,6 +49,7 @@ enum SocketStatus {
 class TinyGsmSequansMonarch
     : public TinyGsmModem<TinyGsmSequansMonarch>,
       public TinyGsmGPRS<TinyGsmSequansMonarch>,
+      public TinyGsmPPP<TinyGsmSequansMonarch>,
       public TinyGsmTCP<TinyGsmSequansMonarch, TINY_GSM_MUX_COUNT>,
       public TinyGsmSSL<TinyGsmSequansMonarch>,
       public TinyGsmCalling<TinyGsmSequansMonarch>,
@@ -62,6 +58,7 @@ class TinyGsmSequansMonarch
       public TinyGsmTemperature<TinyGsmSequansMonarch> {
   friend class TinyGsmModem<TinyGsmSequansMonarch>;
   friend class TinyGsmGPRS<TinyGsmSequansMonarch>;
+  friend class TinyGsmPPP<TinyGsmSequansMonarch>;
   friend class TinyGsmTCP<TinyGsmSequansMonarch, TINY_GSM_MUX_COUNT>;
   friend class TinyGsmSSL<TinyGsmSequansMonarch>;
   friend class TinyGsmCalling<TinyGsmSequansMonarch>;
@@ -238,21 +235,15 @@ class TinyGsmSequansMonarch
   }
 
   String getModemNameImpl() {
+    char res[TINY_GSM_RESPONSE_BUFFER];
     sendAT(GF("+CGMI"));
-    String res1;
-    if (waitResponse(1000L, res1) != 1) { return "unknown"; }
-    res1.replace("\r\nOK\r\n", "");
-    res1.replace("\rOK\r", "");
-    res1.trim();
+    if (waitResponse(1000L, res) != 1) { return "unknown"; }
+    String name = cleanResponse(res);
 
     sendAT(GF("+CGMM"));
-    String res2;
-    if (waitResponse(1000L, res2) != 1) { return "unknown"; }
-    res2.replace("\r\nOK\r\n", "");
-    res2.replace("\rOK\r", "");
-    res2.trim();
-
-    String name = res1 + String(' ') + res2;
+    if (waitResponse(1000L, res) != 1) { return "unknown"; }
+    name += ' ';
+    name += cleanResponse(res);
     DBG("### Modem:", name);
     return name;
   }
@@ -509,12 +500,7 @@ class TinyGsmSequansMonarch
     sendAT(GF("+SQNSSENDEXT="), mux, ',', (uint16_t)len);
     waitResponse(10000L, GF(GSM_NL "> "));
     // Translate bytes into char to be able to send them as an hex string
-    char char_command[2];
-    for (size_t i=0; i<len; i++) {
-      memset(&char_command, 0, sizeof(char_command));
-      sprintf(&char_command[0], "%02X", reinterpret_cast<const uint8_t*>(buff)[i]);
-      stream.write(char_command, sizeof(char_command));
-    }
+    modemWritePayload(buff, len, true);
     stream.flush();
     if (waitResponse() != 1) {
       DBG("### no OK after send");
@@ -558,7 +544,7 @@ class TinyGsmSequansMonarch
         TINY_GSM_YIELD();
       }
       char c = stream.read();
-      sockets[mux % TINY_GSM_MUX_COUNT]->rx.put(c);
+      sockets[mux % TINY_GSM_MUX_COUNT]->rxPut(c);
     }
     // DBG("### READ:", len, "from", mux);
     waitResponse();
@@ -614,111 +600,39 @@ class TinyGsmSequansMonarch
   }
 
   /*
-   * Utilities
+   * URC handlers
    */
- public:
-  // TODO(vshymanskyy): Optimize this!
-  int8_t waitResponse(uint32_t timeout_ms, String& data,
-                      GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    /*String r1s(r1); r1s.trim();
-    String r2s(r2); r2s.trim();
-    String r3s(r3); r3s.trim();
-    String r4s(r4); r4s.trim();
-    String r5s(r5); r5s.trim();
-    DBG("### ..:", r1s, ",", r2s, ",", r3s, ",", r4s, ",", r5s);*/
-    data.reserve(64);
-    uint8_t  index       = 0;
-    uint32_t startMillis = millis();
-    do {
-      TINY_GSM_YIELD();
-      while (stream.available() > 0) {
-        TINY_GSM_YIELD();
-        int8_t a = stream.read();
-        if (a <= 0) continue;  // Skip 0x00 bytes, just in case
-        data += static_cast<char>(a);
-        if (r1 && data.endsWith(r1)) {
-          index = 1;
-          goto finish;
-        } else if (r2 && data.endsWith(r2)) {
-          index = 2;
-          goto finish;
-        } else if (r3 && data.endsWith(r3)) {
-#if defined TINY_GSM_DEBUG
-          if (r3 == GFP(GSM_CME_ERROR)) {
-            streamSkipUntil('\n');  // Read out the error
-          }
-#endif
-          index = 3;
-          goto finish;
-        } else if (r4 && data.endsWith(r4)) {
-          index = 4;
-          goto finish;
-        } else if (r5 && data.endsWith(r5)) {
-          index = 5;
-          goto finish;
-        } else if (data.endsWith(GF(GSM_NL "+SQNSRING:"))) {
-          int8_t  mux = streamGetIntBefore(',');
-          int16_t len = streamGetIntBefore('\n');
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT &&
-              sockets[mux % TINY_GSM_MUX_COUNT]) {
-            sockets[mux % TINY_GSM_MUX_COUNT]->got_data       = true;
-            sockets[mux % TINY_GSM_MUX_COUNT]->sock_available = len;
-          }
-          data = "";
-          DBG("### URC Data Received:", len, "on", mux);
-        } else if (data.endsWith(GF("SQNSH: "))) {
-          int8_t mux = streamGetIntBefore('\n');
-          if (mux >= 0 && mux < TINY_GSM_MUX_COUNT &&
-              sockets[mux % TINY_GSM_MUX_COUNT]) {
-            sockets[mux % TINY_GSM_MUX_COUNT]->sock_connected = false;
-          }
-          data = "";
-          DBG("### URC Sock Closed: ", mux);
-        }
-      }
-    } while (millis() - startMillis < timeout_ms);
-  finish:
-    if (!index) {
-      data.trim();
-      if (data.length()) { DBG("### Unhandled:", data); }
-      data = "";
+ protected:
+  bool handleReceive() {
+    int8_t  mux = streamGetIntBefore(',');
+    int16_t len = streamGetIntBefore('\n');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT &&
+        sockets[mux % TINY_GSM_MUX_COUNT]) {
+      sockets[mux % TINY_GSM_MUX_COUNT]->got_data       = true;
+      sockets[mux % TINY_GSM_MUX_COUNT]->sock_available = len;
     }
-    // data.replace(GSM_NL, "/");
-    // DBG('<', index, '>', data);
-    return index;
+    DBG("### URC Data Received:", len, "on", mux);
+    return true;
   }
 
-  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    String data;
-    return waitResponse(timeout_ms, data, r1, r2, r3, r4, r5);
+  bool handleClosed() {
+    int8_t mux = streamGetIntBefore('\n');
+    if (mux >= 0 && mux < TINY_GSM_MUX_COUNT &&
+        sockets[mux % TINY_GSM_MUX_COUNT]) {
+      sockets[mux % TINY_GSM_MUX_COUNT]->sock_connected = false;
+    }
+    DBG("### URC Sock Closed: ", mux);
+    return true;
   }
 
-  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
-                      GsmConstStr r2 = GFP(GSM_ERROR),
-#if defined TINY_GSM_DEBUG
-                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
-                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
-#else
-                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
-#endif
-                      GsmConstStr r5 = NULL) {
-    return waitResponse(1000, r1, r2, r3, r4, r5);
+  const TinyGsmUrc<TinyGsmSequansMonarch>* urcTable(uint8_t& count) {
+    static constexpr TinyGsmUrc<TinyGsmSequansMonarch> urcs[]
+        TINY_GSM_PROGMEM = {
+            {GSM_NL "+SQNSRING:", &TinyGsmSequansMonarch::handleReceive},
+            {"SQNSH: ", &TinyGsmSequansMonarch::handleClosed},
+        };
+    count = sizeof(urcs) / sizeof(urcs[0]);
+    return urcs;
   }
 
  public:
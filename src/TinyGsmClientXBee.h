@@ -17,9 +17,14 @@
 // The much more complicated API mode is needed for multi-plexing
 #define TINY_GSM_MUX_COUNT 1
 #define TINY_GSM_NO_MODEM_BUFFER
+// Data goes straight out in transparent mode, so this only sets how
+// writes are split up
+#define TINY_GSM_MAX_SEND 1500
 // XBee's have a default guard time of 1 second (1000ms, 10 extra for safety
 // here)
 #define TINY_GSM_XBEE_GUARD_TIME 1010
+// XBee's end their responses with a bare carriage return
+#define GSM_NL "\r"
 
 #include "TinyGsmBattery.tpp"
 #include "TinyGsmGPRS.tpp"
@@ -30,10 +35,6 @@
 #include "TinyGsmTemperature.tpp"
 #include "TinyGsmWifi.tpp"
 
-#define GSM_NL "\r"
-static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
-static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
-
 // Use this to avoid too many entrances and exits from command mode.
 // The cellular Bee's often freeze up and won't respond when attempting
 // to enter command mode too many times.
@@ -138,6 +139,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     }
 
     void stop(uint32_t maxWaitMs) {
+      flushTx();
       at->streamClear();  // Empty anything in the buffer
       // empty the saved currently-in-use destination address
       at->modemStop(maxWaitMs);
@@ -154,6 +156,8 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
       stop(5000L);
     }
 
+    using GsmClient::write;  // For the scatter-gather write
+
     size_t write(const uint8_t* buf, size_t size) override {
       TINY_GSM_YIELD();
       return at->modemSend(buf, size, mux);
@@ -381,8 +385,8 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     return getBeeName();
   }
 
-  void setBaudImpl(uint32_t baud) {
-    XBEE_COMMAND_START_DECORATOR(5, )
+  bool setBaudImpl(uint32_t baud) {
+    XBEE_COMMAND_START_DECORATOR(5, false)
     bool changesMade = false;
     switch (baud) {
       case 2400: changesMade |= changeSettingIfNeeded(GF("BD"), 0x1); break;
@@ -402,8 +406,22 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
         break;
       }
     }
-    if (changesMade) { writeChanges(); }
+    bool success = true;
+    if (changesMade) { success = writeChanges(); }
     XBEE_COMMAND_END_DECORATOR
+    return success;
+  }
+
+  bool setFlowControlImpl(FlowControl mode) {
+    XBEE_COMMAND_START_DECORATOR(5, false)
+    int16_t value = mode == FLOW_CONTROL_RTSCTS ? 1 : 0;
+    // D7 is the CTS output and D6 the RTS input
+    bool changesMade = changeSettingIfNeeded(GF("D7"), value);
+    changesMade |= changeSettingIfNeeded(GF("D6"), value);
+    bool success = true;
+    if (changesMade) { success = writeChanges(); }
+    XBEE_COMMAND_END_DECORATOR
+    return success;
   }
 
   bool testATImpl(uint32_t timeout_ms = 10000L) {
@@ -1223,7 +1241,7 @@ class TinyGsmXBee : public TinyGsmModem<TinyGsmXBee>,
     if (mux != 0) {
       DBG("XBee only supports 1 IP channel in transparent mode!");
     }
-    stream.write(reinterpret_cast<const uint8_t*>(buff), len);
+    modemWritePayload(buff, len);
     stream.flush();
 
     if (beeType != XBEE_S6B_WIFI) {
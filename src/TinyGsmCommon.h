@@ -46,11 +46,19 @@
 typedef const __FlashStringHelper* GsmConstStr;
 #define GFP(x) (reinterpret_cast<GsmConstStr>(x))
 #define GF(x) F(x)
+#define TINY_GSM_PGM_CHAR(p) static_cast<char>(pgm_read_byte(p))
+#define TINY_GSM_PGM_BYTE(p) static_cast<uint8_t>(pgm_read_byte(p))
+#define TINY_GSM_PGM_WORD(p) static_cast<uint16_t>(pgm_read_word(p))
+#define TINY_GSM_MEMCPY_P(dst, src, n) memcpy_P(dst, src, n)
 #else
 #define TINY_GSM_PROGMEM
 typedef const char* GsmConstStr;
 #define GFP(x) x
 #define GF(x) x
+#define TINY_GSM_PGM_CHAR(p) (*(p))
+#define TINY_GSM_PGM_BYTE(p) (*(p))
+#define TINY_GSM_PGM_WORD(p) (*(p))
+#define TINY_GSM_MEMCPY_P(dst, src, n) memcpy(dst, src, n)
 #endif
 
 #ifdef TINY_GSM_DEBUG
@@ -90,26 +98,83 @@ const T& TinyGsmMax(const T& a, const T& b) {
   return (b < a) ? a : b;
 }
 
+// std::is_same, which not every board's toolchain has
+template <class A, class B>
+struct TinyGsmIsSame {
+  static const bool value = false;
+};
+template <class A>
+struct TinyGsmIsSame<A, A> {
+  static const bool value = true;
+};
+
+// Settings whose last applied value sendATCached() remembers, so that they
+// are only sent again when they are different or the modem may have lost
+// them
+enum TinyGsmSetting {
+  SETTING_CMGF,      // SMS text (1) or PDU (0) mode
+  SETTING_CSCS,      // Character set, GSM (0) or HEX (1)
+  SETTING_CSMP,      // Data coding scheme of text mode SMS
+  SETTING_CNTPCID,   // Bearer profile used for NTP
+  SETTING_CIPRXGET,  // Reading received data manually
+  SETTING_COUNT
+};
+
+// How long each "AT" sent while searching for the baud rate waits for the
+// "OK", and how often it is sent at each rate.  The window covers the echo
+// and the "OK" even at 2400 baud.
+#if !defined(TINY_GSM_AUTOBAUD_PROBE_MS)
+#define TINY_GSM_AUTOBAUD_PROBE_MS 100
+#endif
+#if !defined(TINY_GSM_AUTOBAUD_PROBES)
+#define TINY_GSM_AUTOBAUD_PROBES 3
+#endif
+
+// Sends "AT" and watches the reply as it arrives, returning as soon as the
+// "OK" is in instead of waiting out the stream's time-out
 template <class T>
-uint32_t TinyGsmAutoBaud(T& SerialAT, uint32_t minimum = 9600,
-                         uint32_t maximum = 115200) {
-  static uint32_t rates[] = {115200, 57600,  38400, 19200, 9600,  74400, 74880,
-                             230400, 460800, 2400,  4800,  14400, 28800};
+bool TinyGsmProbeBaud(T& SerialAT, uint32_t rate) {
+  SerialAT.begin(rate);
+  delay(10);
+  for (uint8_t j = 0; j < TINY_GSM_AUTOBAUD_PROBES; j++) {
+    while (SerialAT.available()) { SerialAT.read(); }  // Noise and old replies
+    SerialAT.print("AT\r\n");
+    char     prev        = 0;
+    uint32_t startMillis = millis();
+    while (millis() - startMillis < TINY_GSM_AUTOBAUD_PROBE_MS) {
+      int c = SerialAT.read();
+      if (c < 0) { continue; }
+      if (prev == 'O' && c == 'K') { return true; }
+      prev = c;
+    }
+  }
+  return false;
+}
 
+// Finds the modem's baud rate, trying hint (e.g. the last rate found,
+// persisted across boots) first and then the rates most often used
+template <class T>
+uint32_t TinyGsmAutoBaud(T& SerialAT, uint32_t minimum = 9600,
+                         uint32_t maximum = 115200, uint32_t hint = 0) {
+  static const uint32_t rates[] = {115200, 9600,   57600, 38400, 19200,
+                                   230400, 460800, 4800,  2400,  14400,
+                                   28800,  74400,  74880};
+
+  if (hint >= minimum && hint <= maximum) {
+    DBG("Trying baud rate", hint, "...");
+    if (TinyGsmProbeBaud(SerialAT, hint)) {
+      DBG("Modem responded at rate", hint);
+      return hint;
+    }
+  }
   for (uint8_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
     uint32_t rate = rates[i];
-    if (rate < minimum || rate > maximum) continue;
+    if (rate < minimum || rate > maximum || rate == hint) continue;
 
     DBG("Trying baud rate", rate, "...");
-    SerialAT.begin(rate);
-    delay(10);
-    for (int j = 0; j < 10; j++) {
-      SerialAT.print("AT\r\n");
-      String input = SerialAT.readString();
-      if (input.indexOf("OK") >= 0) {
-        DBG("Modem responded at rate", rate);
-        return rate;
-      }
+    if (TinyGsmProbeBaud(SerialAT, rate)) {
+      DBG("Modem responded at rate", rate);
+      return rate;
     }
   }
   SerialAT.begin(minimum);
@@ -1,19 +1,73 @@
 #ifndef TinyGsmFifo_h
 #define TinyGsmFifo_h
 
-template <class T, unsigned N>
-class TinyGsmFifo
+// With TINY_GSM_FIFO_SPSC defined the read and write indices are published
+// with acquire/release ordering, so that one producer and one consumer may
+// use a fifo at the same time without any lock: e.g. a UART RX interrupt
+// filling it while the main loop reads, or two threads on a host.  Only the
+// producer may use the writing API and only the consumer the reading API;
+// attach() and clear() need both sides to be idle.
+#if defined(TINY_GSM_FIFO_SPSC) && defined(__AVR__)
+// 16 bit loads and stores aren't atomic on AVR, so briefly mask interrupts
+#include <util/atomic.h>
+#define TINY_GSM_FIFO_LOAD(x) \
+    ({ unsigned _v; ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { _v = (x); } _v; })
+#define TINY_GSM_FIFO_STORE(x, v) \
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { (x) = (v); }
+#elif defined(TINY_GSM_FIFO_SPSC)
+#define TINY_GSM_FIFO_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define TINY_GSM_FIFO_STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#else
+#define TINY_GSM_FIFO_LOAD(x) (x)
+#define TINY_GSM_FIFO_STORE(x, v) ((x) = (v))
+#endif
+
+// What the blocking put()/get() do while waiting for the other side
+#if defined(TINY_GSM_YIELD)
+#define TINY_GSM_FIFO_WAIT() TINY_GSM_YIELD()
+#else
+#define TINY_GSM_FIFO_WAIT()
+#endif
+
+// Ring buffer over storage owned by someone else, so that code using it
+// doesn't depend on its capacity.  Holds at most n - 1 items.
+//
+// When n is a power of two the indices wrap with a mask instead of a
+// division, which is much cheaper on small MCU's.
+//
+// Besides copying items in and out, the free space and the queued items can
+// be used in place: writeSpan()/commitWrite() let a producer fill the buffer
+// directly and readSpan()/commitRead() let a consumer parse it directly.  A
+// span never wraps, so it may be shorter than free()/size(); call again after
+// committing to get the rest.
+template <class T>
+class TinyGsmFifoView
 {
 public:
-    TinyGsmFifo()
+    // Without storage it holds nothing; whatever is put is dropped
+    TinyGsmFifoView()
     {
+        attach(NULL, 1);
+    }
+
+    TinyGsmFifoView(T* b, unsigned n)
+    {
+        attach(b, n);
+    }
+
+    // Switches to other storage, dropping anything queued
+    void attach(T* b, unsigned n)
+    {
+        _b = b;
+        _n = n;
+        _mask = (n & (n - 1)) ? 0 : n - 1;
         clear();
     }
 
     void clear()
     {
-        _r = 0;
-        _w = 0;
+        TINY_GSM_FIFO_STORE(_r, 0u);
+        TINY_GSM_FIFO_STORE(_w, 0u);
     }
 
     // writing thread/context API
@@ -26,21 +80,36 @@ public:
 
     int free(void)
     {
-        int s = _r - _w;
-        if (s <= 0)
-            s += N;
-        return s - 1;
+        unsigned r = TINY_GSM_FIFO_LOAD(_r);
+        unsigned w = TINY_GSM_FIFO_LOAD(_w);
+        return (r > w ? r - w : r + _n - w) - 1;
+    }
+
+    // Contiguous free space starting at the write position; len is set to
+    // how many items may be written there before commitWrite()
+    T* writeSpan(size_t& len)
+    {
+        unsigned w = TINY_GSM_FIFO_LOAD(_w);
+        unsigned f = free();
+        unsigned m = _n - w;
+        len = f < m ? f : m;
+        return &_b[w];
+    }
+
+    // Queues n items written in place through writeSpan()
+    void commitWrite(size_t n)
+    {
+        TINY_GSM_FIFO_STORE(_w, _inc(TINY_GSM_FIFO_LOAD(_w), n));
     }
 
     bool put(const T& c)
     {
-        int i = _w;
-        int j = i;
-        i = _inc(i);
-        if (i == _r) // !writeable()
+        unsigned w = TINY_GSM_FIFO_LOAD(_w);
+        unsigned i = _inc(w);
+        if (i == TINY_GSM_FIFO_LOAD(_r)) // !writeable()
             return false;
-        _b[j] = c;
-        _w = i;
+        _b[w] = c;
+        TINY_GSM_FIFO_STORE(_w, i);
         return true;
     }
 
@@ -49,20 +118,16 @@ public:
         int c = n;
         while (c)
         {
-            int f;
-            while ((f = free()) == 0) // wait for space
+            size_t f;
+            T* s;
+            while ((s = writeSpan(f)), f == 0) // wait for space
             {
                 if (!t) return n - c; // no more space and not blocking
-                /* nothing / just wait */;
+                TINY_GSM_FIFO_WAIT();
             }
-            // check free space
-            if (c < f) f = c;
-            int w = _w;
-            int m = N - w;
-            // check wrap
-            if (f > m) f = m;
-            memcpy(&_b[w], p, f);
-            _w = _inc(w, f);
+            if ((size_t)c < f) f = c;
+            memcpy(s, p, f * sizeof(T));
+            commitWrite(f);
             c -= f;
             p += f;
         }
@@ -74,24 +139,40 @@ public:
 
     bool readable(void)
     {
-        return (_r != _w);
+        return TINY_GSM_FIFO_LOAD(_r) != TINY_GSM_FIFO_LOAD(_w);
     }
 
     size_t size(void)
     {
-        int s = _w - _r;
-        if (s < 0)
-            s += N;
-        return s;
+        unsigned r = TINY_GSM_FIFO_LOAD(_r);
+        unsigned w = TINY_GSM_FIFO_LOAD(_w);
+        return w >= r ? w - r : w + _n - r;
+    }
+
+    // Contiguous queued items starting at the read position; len is set to
+    // how many there are.  They stay queued until commitRead()
+    const T* readSpan(size_t& len)
+    {
+        unsigned r = TINY_GSM_FIFO_LOAD(_r);
+        unsigned s = size();
+        unsigned m = _n - r;
+        len = s < m ? s : m;
+        return &_b[r];
+    }
+
+    // Drops n items consumed in place through readSpan()
+    void commitRead(size_t n)
+    {
+        TINY_GSM_FIFO_STORE(_r, _inc(TINY_GSM_FIFO_LOAD(_r), n));
     }
 
     bool get(T* p)
     {
-        int r = _r;
-        if (r == _w) // !readable()
+        unsigned r = TINY_GSM_FIFO_LOAD(_r);
+        if (r == TINY_GSM_FIFO_LOAD(_w)) // !readable()
             return false;
         *p = _b[r];
-        _r = _inc(r);
+        TINY_GSM_FIFO_STORE(_r, _inc(r));
         return true;
     }
 
@@ -100,42 +181,56 @@ public:
         int c = n;
         while (c)
         {
-            int f;
-            for (;;) // wait for data
+            size_t f;
+            const T* s;
+            while ((s = readSpan(f)), f == 0) // wait for data
             {
-                f = size();
-                if (f)  break;        // free space
-                if (!t) return n - c; // no space and not blocking
-                /* nothing / just wait */;
+                if (!t) return n - c; // no data and not blocking
+                TINY_GSM_FIFO_WAIT();
             }
-            // check available data
-            if (c < f) f = c;
-            int r = _r;
-            int m = N - r;
-            // check wrap
-            if (f > m) f = m;
-            memcpy(p, &_b[r], f);
-            _r = _inc(r, f);
+            if ((size_t)c < f) f = c;
+            memcpy(p, s, f * sizeof(T));
+            commitRead(f);
             c -= f;
             p += f;
         }
         return n - c;
     }
 
-	uint8_t peek()
-	{
-		return _b[_r];
-	}
+    // The next item without removing it, or -1 if there is none
+    int peek()
+    {
+        unsigned r = TINY_GSM_FIFO_LOAD(_r);
+        if (r == TINY_GSM_FIFO_LOAD(_w))
+            return -1;
+        return _b[r];
+    }
 
 private:
-    int _inc(int i, int n = 1)
+    unsigned _inc(unsigned i, unsigned n = 1)
     {
-        return (i + n) % N;
+        return _mask ? (i + n) & _mask : (i + n) % _n;
     }
 
-    T    _b[N];
-    int  _w;
-    int  _r;
+    T*       _b;
+    unsigned _n;
+    unsigned _mask;
+    unsigned _w;
+    unsigned _r;
+};
+
+// Ring buffer with its own storage for N - 1 items
+template <class T, unsigned N>
+class TinyGsmFifo : public TinyGsmFifoView<T>
+{
+public:
+    TinyGsmFifo() : TinyGsmFifoView<T>(_s, N) {}
+
+private:
+    TinyGsmFifo(const TinyGsmFifo&);
+    TinyGsmFifo& operator=(const TinyGsmFifo&);
+
+    T _s[N];
 };
 
 #endif
@@ -51,9 +51,12 @@ class TinyGsmGPRS {
    */
   bool gprsConnect(const char* apn, const char* user = NULL,
                    const char* pwd = NULL) {
+    // Some modems reset their TCP/IP settings with the bearer
+    thisModem().forgetSetting(SETTING_CIPRXGET);
     return thisModem().gprsConnectImpl(apn, user, pwd);
   }
   bool gprsDisconnect() {
+    thisModem().forgetSetting(SETTING_CIPRXGET);
     return thisModem().gprsDisconnectImpl();
   }
   // Checks if current attached to GPRS/EPS service
@@ -0,0 +1,217 @@
+/**
+ * @file       TinyGsmHdlc.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Nov 2016
+ */
+
+#ifndef SRC_TINYGSMHDLC_H_
+#define SRC_TINYGSMHDLC_H_
+
+#include "TinyGsmCommon.h"
+
+// The largest frame received, from the address field to the FCS: the
+// default PPP MRU of 1500 plus 6 bytes.  Longer frames are dropped.
+#if !defined(TINY_GSM_HDLC_FRAME)
+#define TINY_GSM_HDLC_FRAME 1506
+#endif
+
+// FCS-16 lookup table for the reversed polynomial x^16 + x^12 + x^5 + 1
+static const uint16_t TinyGsmHdlcFcsTable[256] TINY_GSM_PROGMEM = {
+    0x0000, 0x1189, 0x2312, 0x329B, 0x4624, 0x57AD, 0x6536, 0x74BF,
+    0x8C48, 0x9DC1, 0xAF5A, 0xBED3, 0xCA6C, 0xDBE5, 0xE97E, 0xF8F7,
+    0x1081, 0x0108, 0x3393, 0x221A, 0x56A5, 0x472C, 0x75B7, 0x643E,
+    0x9CC9, 0x8D40, 0xBFDB, 0xAE52, 0xDAED, 0xCB64, 0xF9FF, 0xE876,
+    0x2102, 0x308B, 0x0210, 0x1399, 0x6726, 0x76AF, 0x4434, 0x55BD,
+    0xAD4A, 0xBCC3, 0x8E58, 0x9FD1, 0xEB6E, 0xFAE7, 0xC87C, 0xD9F5,
+    0x3183, 0x200A, 0x1291, 0x0318, 0x77A7, 0x662E, 0x54B5, 0x453C,
+    0xBDCB, 0xAC42, 0x9ED9, 0x8F50, 0xFBEF, 0xEA66, 0xD8FD, 0xC974,
+    0x4204, 0x538D, 0x6116, 0x709F, 0x0420, 0x15A9, 0x2732, 0x36BB,
+    0xCE4C, 0xDFC5, 0xED5E, 0xFCD7, 0x8868, 0x99E1, 0xAB7A, 0xBAF3,
+    0x5285, 0x430C, 0x7197, 0x601E, 0x14A1, 0x0528, 0x37B3, 0x263A,
+    0xDECD, 0xCF44, 0xFDDF, 0xEC56, 0x98E9, 0x8960, 0xBBFB, 0xAA72,
+    0x6306, 0x728F, 0x4014, 0x519D, 0x2522, 0x34AB, 0x0630, 0x17B9,
+    0xEF4E, 0xFEC7, 0xCC5C, 0xDDD5, 0xA96A, 0xB8E3, 0x8A78, 0x9BF1,
+    0x7387, 0x620E, 0x5095, 0x411C, 0x35A3, 0x242A, 0x16B1, 0x0738,
+    0xFFCF, 0xEE46, 0xDCDD, 0xCD54, 0xB9EB, 0xA862, 0x9AF9, 0x8B70,
+    0x8408, 0x9581, 0xA71A, 0xB693, 0xC22C, 0xD3A5, 0xE13E, 0xF0B7,
+    0x0840, 0x19C9, 0x2B52, 0x3ADB, 0x4E64, 0x5FED, 0x6D76, 0x7CFF,
+    0x9489, 0x8500, 0xB79B, 0xA612, 0xD2AD, 0xC324, 0xF1BF, 0xE036,
+    0x18C1, 0x0948, 0x3BD3, 0x2A5A, 0x5EE5, 0x4F6C, 0x7DF7, 0x6C7E,
+    0xA50A, 0xB483, 0x8618, 0x9791, 0xE32E, 0xF2A7, 0xC03C, 0xD1B5,
+    0x2942, 0x38CB, 0x0A50, 0x1BD9, 0x6F66, 0x7EEF, 0x4C74, 0x5DFD,
+    0xB58B, 0xA402, 0x9699, 0x8710, 0xF3AF, 0xE226, 0xD0BD, 0xC134,
+    0x39C3, 0x284A, 0x1AD1, 0x0B58, 0x7FE7, 0x6E6E, 0x5CF5, 0x4D7C,
+    0xC60C, 0xD785, 0xE51E, 0xF497, 0x8028, 0x91A1, 0xA33A, 0xB2B3,
+    0x4A44, 0x5BCD, 0x6956, 0x78DF, 0x0C60, 0x1DE9, 0x2F72, 0x3EFB,
+    0xD68D, 0xC704, 0xF59F, 0xE416, 0x90A9, 0x8120, 0xB3BB, 0xA232,
+    0x5AC5, 0x4B4C, 0x79D7, 0x685E, 0x1CE1, 0x0D68, 0x3FF3, 0x2E7A,
+    0xE70E, 0xF687, 0xC41C, 0xD595, 0xA12A, 0xB0A3, 0x8238, 0x93B1,
+    0x6B46, 0x7ACF, 0x4854, 0x59DD, 0x2D62, 0x3CEB, 0x0E70, 0x1FF9,
+    0xF78F, 0xE606, 0xD49D, 0xC514, 0xB1AB, 0xA022, 0x92B9, 0x8330,
+    0x7BC7, 0x6A4E, 0x58D5, 0x495C, 0x3DE3, 0x2C6A, 0x1EF1, 0x0F78};
+
+// Called with each received frame that passed the FCS check, from its address
+// field up to but without the FCS.  The frame may be changed in place but is
+// only valid until the callback returns.
+typedef void (*TinyGsmFrameCallback)(uint8_t* frame, size_t len, void* arg);
+
+// RFC 1662 HDLC-like framing, as used by PPP over a serial port.
+//
+// Turns the byte stream of a dialed PPP link (see TinyGsmPPP.tpp) into whole
+// checked frames for an IP stack that doesn't frame by itself, and back.
+// Control characters in the async control character map (all of them until
+// LCP negotiates otherwise) are escaped on sending and, when received
+// unescaped, dropped as noise.
+class TinyGsmHdlc {
+ public:
+  explicit TinyGsmHdlc(Stream& stream) : stream(stream) {}
+
+  void setFrameCallback(TinyGsmFrameCallback callback, void* arg = NULL) {
+    rx_callback = callback;
+    rx_arg      = arg;
+  }
+
+  // The async control character maps negotiated by LCP
+  void setTxAccm(uint32_t accm) {
+    tx_accm = accm;
+  }
+  void setRxAccm(uint32_t accm) {
+    rx_accm = accm;
+  }
+
+  /*
+   * Sending
+   */
+  // Sends one frame, from its address field up to but without the FCS
+  void sendFrame(const uint8_t* data, size_t len) {
+    beginFrame();
+    writeFrame(data, len);
+    endFrame();
+  }
+
+  // The same in pieces, for stacks that hold a frame in a chain of buffers
+  void beginFrame() {
+    tx_fcs = 0xFFFF;
+    tx_len = 0;
+    tx_buf[tx_len++] = HDLC_FLAG;
+  }
+  void writeFrame(const uint8_t* data, size_t len) {
+    tx_fcs = fcs16(tx_fcs, data, len);
+    while (len--) { putEscaped(*data++); }
+  }
+  void endFrame() {
+    uint16_t f = ~tx_fcs;
+    putEscaped(f & 0xFF);
+    putEscaped(f >> 8);
+    putRaw(HDLC_FLAG);
+    stream.write(tx_buf, tx_len);
+    tx_len = 0;
+  }
+
+  /*
+   * Receiving
+   */
+  // Reads everything received so far, calling the frame callback for each
+  // good frame
+  void poll() {
+    uint8_t buf[32];
+    int     n;
+    while ((n = stream.available()) > 0) {
+      n = stream.readBytes(buf,
+                           TinyGsmMin(static_cast<size_t>(n), sizeof(buf)));
+      if (n <= 0) { break; }
+      for (int i = 0; i < n; i++) { rxByte(buf[i]); }
+    }
+  }
+
+  // Frames dropped for a bad FCS, being too long or aborted
+  uint16_t badFrames() const {
+    return bad_frames;
+  }
+
+  static uint16_t fcs16(uint16_t fcs, const uint8_t* p, size_t n) {
+    while (n--) {
+      uint8_t i = (fcs ^ *p++) & 0xFF;
+      fcs       = (fcs >> 8) ^ TINY_GSM_PGM_WORD(&TinyGsmHdlcFcsTable[i]);
+    }
+    return fcs;
+  }
+
+ private:
+  enum {
+    HDLC_FLAG   = 0x7E,
+    HDLC_ESCAPE = 0x7D,
+    HDLC_XOR    = 0x20,
+    // The FCS over a frame and its own FCS
+    FCS_GOOD = 0xF0B8
+  };
+
+  void putRaw(uint8_t c) {
+    if (tx_len == sizeof(tx_buf)) {
+      stream.write(tx_buf, tx_len);
+      tx_len = 0;
+    }
+    tx_buf[tx_len++] = c;
+  }
+
+  void putEscaped(uint8_t c) {
+    if (c == HDLC_FLAG || c == HDLC_ESCAPE ||
+        (c < 0x20 && (tx_accm & (1UL << c)))) {
+      putRaw(HDLC_ESCAPE);
+      c ^= HDLC_XOR;
+    }
+    putRaw(c);
+  }
+
+  void rxByte(uint8_t c) {
+    if (c == HDLC_FLAG) {
+      if (rx_escape) {
+        bad_frames++;  // Aborted by the sender
+      } else if (rx_len > TINY_GSM_HDLC_FRAME) {
+        bad_frames++;
+      } else if (rx_len >= 4) {
+        if (fcs16(0xFFFF, rx_frame, rx_len) == FCS_GOOD) {
+          if (rx_callback) { rx_callback(rx_frame, rx_len - 2, rx_arg); }
+        } else {
+          bad_frames++;
+        }
+      } else if (rx_len) {
+        bad_frames++;
+      }
+      rx_len    = 0;
+      rx_escape = false;
+      return;
+    }
+    if (c < 0x20 && (rx_accm & (1UL << c))) { return; }
+    if (c == HDLC_ESCAPE) {
+      rx_escape = true;
+      return;
+    }
+    if (rx_escape) {
+      c ^= HDLC_XOR;
+      rx_escape = false;
+    }
+    // Counts on past the end, so that an overlong frame is dropped
+    if (rx_len < TINY_GSM_HDLC_FRAME) { rx_frame[rx_len] = c; }
+    if (rx_len <= TINY_GSM_HDLC_FRAME) { rx_len++; }
+  }
+
+  Stream&              stream;
+  TinyGsmFrameCallback rx_callback = NULL;
+  void*                rx_arg      = NULL;
+  uint32_t             tx_accm     = 0xFFFFFFFF;
+  uint32_t             rx_accm     = 0xFFFFFFFF;
+  uint16_t             bad_frames  = 0;
+
+  uint16_t tx_fcs;
+  uint8_t  tx_buf[32];
+  uint8_t  tx_len = 0;
+
+  uint8_t rx_frame[TINY_GSM_HDLC_FRAME];
+  size_t  rx_len    = 0;
+  bool    rx_escape = false;
+};
+
+#endif  // SRC_TINYGSMHDLC_H_
@@ -0,0 +1,225 @@
+/**
+ * @file       TinyGsmMatcher.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Nov 2016
+ */
+
+#ifndef SRC_TINYGSMMATCHER_H_
+#define SRC_TINYGSMMATCHER_H_
+
+#include "TinyGsmCommon.h"
+
+// Incremental response matcher used by waitResponse.
+//
+// Every byte read from the modem goes into a small ring window (N bytes, used
+// by URC handlers that need to look back at the current line and for debug
+// output) and advances one match state per pattern.  Each state is the length
+// of the longest pattern prefix that the received bytes currently end with,
+// so a pattern is found the moment its last character arrives without ever
+// re-scanning the received data and without any heap allocation.
+//
+// Patterns are plain C strings; on AVR they must live in PROGMEM, like every
+// other GsmConstStr.
+template <uint8_t N, uint8_t P>
+class TinyGsmMatcher {
+  static_assert(N && (N & (N - 1)) == 0,
+                "TinyGsmMatcher window size must be a power of two");
+
+ public:
+  TinyGsmMatcher() {
+    clear();
+  }
+
+  // Forgets both the window contents and all partial matches
+  void clear() {
+    _end = 0;
+    _len = 0;
+    memset(_state, 0, sizeof(_state));
+  }
+
+  void put(char c) {
+    _buf[_end] = c;
+    _end       = (_end + 1) & (N - 1);
+    if (_len < N) { _len++; }
+  }
+
+  // Feeds one character to pattern slot i, returning true when the whole
+  // pattern has just been received.
+  bool step(uint8_t i, const char* pattern, char c) {
+    if (i >= P || !pattern) { return false; }
+    uint8_t k = _state[i];
+    if (TINY_GSM_PGM_CHAR(pattern + k) == c) {
+      k++;
+    } else {
+      k = fallback(pattern, k, c);
+    }
+    if (k && !TINY_GSM_PGM_CHAR(pattern + k)) {
+      _state[i] = 0;
+      return true;
+    }
+    _state[i] = k;
+    return false;
+  }
+
+  // How many characters of the pattern in slot i have been received so far
+  uint8_t progress(uint8_t i) const {
+    return i < P ? _state[i] : 0;
+  }
+
+  /*
+   * Window access
+   */
+  uint8_t length() const {
+    return _len;
+  }
+
+  // Character i of the window, 0 being the oldest one still held
+  char operator[](uint8_t i) const {
+    return _buf[(_end - _len + i) & (N - 1)];
+  }
+
+  // Parses the integer the current line starts with, ignoring any line
+  // ending just received.  Used for URC's such as "<mux>, CLOSED".
+  // Returns -1 if the line doesn't start with a number.
+  int16_t lineInt() const {
+    uint8_t i = _len;
+    while (i && ((*this)[i - 1] == '\r' || (*this)[i - 1] == '\n')) { i--; }
+    while (i && (*this)[i - 1] != '\n') { i--; }
+    while (i < _len && (*this)[i] == ' ') { i++; }
+    if (i >= _len || (*this)[i] < '0' || (*this)[i] > '9') { return -1; }
+    int16_t res = 0;
+    for (; i < _len && (*this)[i] >= '0' && (*this)[i] <= '9'; i++) {
+      res = res * 10 + ((*this)[i] - '0');
+    }
+    return res;
+  }
+
+  // Whether the window currently ends with the given string
+  bool endsWith(const char* str) const {
+    uint8_t n = 0;
+    while (TINY_GSM_PGM_CHAR(str + n)) { n++; }
+    if (!n || n > _len) { return false; }
+    for (uint8_t i = 1; i <= n; i++) {
+      if ((*this)[_len - i] != TINY_GSM_PGM_CHAR(str + n - i)) { return false; }
+    }
+    return true;
+  }
+
+  // Copies the window into buf as a null terminated string
+  size_t copyTo(char* buf, size_t size) const {
+    if (!buf || !size) { return 0; }
+    size_t n = TinyGsmMin(static_cast<size_t>(_len), size - 1);
+    for (size_t i = 0; i < n; i++) { buf[i] = (*this)[_len - n + i]; }
+    buf[n] = '\0';
+    return n;
+  }
+
+ private:
+  // After a mismatch at state k, finds the longest prefix of the pattern that
+  // is still a suffix of what has been received.  Only needs the pattern
+  // itself, as the last k characters received are its first k characters.
+  static uint8_t fallback(const char* pattern, uint8_t k, char c) {
+    for (uint8_t l = k; l > 0; l--) {
+      if (TINY_GSM_PGM_CHAR(pattern + l - 1) != c) { continue; }
+      uint8_t j = 0;
+      while (j < l - 1 && TINY_GSM_PGM_CHAR(pattern + j) ==
+                              TINY_GSM_PGM_CHAR(pattern + k - l + 1 + j)) {
+        j++;
+      }
+      if (j == l - 1) { return l; }
+    }
+    return 0;
+  }
+
+  char    _buf[N];
+  uint8_t _end;
+  uint8_t _len;
+  uint8_t _state[P];
+};
+
+// Where waitResponse copies the characters it receives: nowhere, a String,
+// or a fixed caller-owned buffer that is kept null terminated.  Characters
+// that don't fit in the buffer are dropped.
+class TinyGsmCapture {
+ public:
+  TinyGsmCapture() : _str(NULL), _buf(NULL), _cap(0), _len(0) {}
+  explicit TinyGsmCapture(String* str)
+      : _str(str), _buf(NULL), _cap(0), _len(0) {}
+  TinyGsmCapture(char* buf, size_t cap)
+      : _str(NULL), _buf(buf), _cap(buf ? cap : 0), _len(0) {
+    clear();
+  }
+
+  void put(char c) {
+    if (_str) {
+      *_str += c;
+    } else if (_len + 1 < _cap) {
+      _buf[_len++] = c;
+      _buf[_len]   = '\0';
+    }
+  }
+
+  void clear() {
+    if (_str) { *_str = ""; }
+    if (_cap) { _buf[0] = '\0'; }
+    _len = 0;
+  }
+
+ private:
+  String* _str;
+  char*   _buf;
+  size_t  _cap;
+  size_t  _len;
+};
+
+// Dispatch index over a modem's URC table.
+//
+// URC's are grouped by the last character of their prefix, so for each byte
+// received only the (usually zero) URC's ending with that character need to
+// be checked against the matcher window.  The cost per byte therefore no
+// longer depends on how many URC's a modem supports.  The index is built
+// once, the first time the table is used.
+template <uint8_t U>
+class TinyGsmUrcIndex {
+  static_assert(U <= 16, "TinyGsmUrcIndex supports at most 16 URC's");
+
+ public:
+  TinyGsmUrcIndex() : _built(false) {}
+
+  bool built() const {
+    return _built;
+  }
+
+  template <class Urc>
+  void build(const Urc* urcs, uint8_t count) {
+    memset(_buckets, 0, sizeof(_buckets));
+    for (uint8_t i = 0; i < count && i < U; i++) {
+      const char* prefix = urcs[i].prefix;
+      char        last   = '\0';
+      for (uint8_t j = 0; TINY_GSM_PGM_CHAR(prefix + j); j++) {
+        last = TINY_GSM_PGM_CHAR(prefix + j);
+      }
+      if (last) { _buckets[bucket(last)] |= static_cast<uint16_t>(1U << i); }
+    }
+    _built = true;
+  }
+
+  // Bit mask of the URC's that may have just been completed by c
+  uint16_t candidates(char c) const {
+    return _buckets[bucket(c)];
+  }
+
+ private:
+  // Keeps the usual prefix endings (':', ' ', ',', '\n') in separate buckets
+  static uint8_t bucket(char c) {
+    uint8_t u = static_cast<uint8_t>(c);
+    return (u ^ (u >> 4)) & 0x0F;
+  }
+
+  uint16_t _buckets[16];
+  bool     _built;
+};
+
+#endif  // SRC_TINYGSMMATCHER_H_
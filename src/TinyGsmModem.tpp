@@ -10,6 +10,103 @@
 #define SRC_TINYGSMMODEM_H_
 
 #include "TinyGsmCommon.h"
+#include "TinyGsmMatcher.h"
+
+#ifndef GSM_NL
+#define GSM_NL "\r\n"
+#endif
+static const char GSM_OK[] TINY_GSM_PROGMEM    = "OK" GSM_NL;
+static const char GSM_ERROR[] TINY_GSM_PROGMEM = "ERROR" GSM_NL;
+#if defined       TINY_GSM_DEBUG
+static const char GSM_CME_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CME ERROR:";
+static const char GSM_CMS_ERROR[] TINY_GSM_PROGMEM = GSM_NL "+CMS ERROR:";
+#endif
+// Registration reports, in the order of the cached states
+static const char GSM_CREG[] TINY_GSM_PROGMEM  = GSM_NL "+CREG:";
+static const char GSM_CGREG[] TINY_GSM_PROGMEM = GSM_NL "+CGREG:";
+static const char GSM_CEREG[] TINY_GSM_PROGMEM = GSM_NL "+CEREG:";
+// Sent by modems that have just started, e.g. "RDY" or "APP RDY"
+static const char GSM_RDY[] TINY_GSM_PROGMEM = "RDY";
+
+// Size of the window of recently received characters kept by waitResponse
+#if !defined(TINY_GSM_RESPONSE_WINDOW)
+#define TINY_GSM_RESPONSE_WINDOW 64
+#endif
+
+// Size of the stack buffers used to capture short query responses, such as
+// the modem name or local IP address
+#if !defined(TINY_GSM_RESPONSE_BUFFER)
+#define TINY_GSM_RESPONSE_BUFFER 128
+#endif
+
+// Maximum number of URC's a single modem can register (at most 16)
+#if !defined(TINY_GSM_URC_MAX)
+#define TINY_GSM_URC_MAX 10
+#endif
+
+// An unsolicited result code and the modem function that handles it.
+// The handler is called just after the prefix has been received and should
+// read the rest of the URC from the stream.  It returns false if the data
+// turned out not to be a URC after all.
+template <class modemType>
+struct TinyGsmUrc {
+  char prefix[16];
+  bool (modemType::*handle)();
+};
+
+// Number of commands sendATBatch writes ahead of their results.  V.25ter asks
+// for each command line to wait for the result of the previous one, so this
+// should only be raised for modems known to queue their input.
+#if !defined(TINY_GSM_BATCH_DEPTH)
+#define TINY_GSM_BATCH_DEPTH 1
+#endif
+
+// While waiting for the network with registration reports turned on, how
+// often the registration is still queried in case a report was missed
+#if !defined(TINY_GSM_REG_POLL_MS)
+#define TINY_GSM_REG_POLL_MS 5000
+#endif
+
+// Maximum number of received characters parsed by a single call to poll()
+#if !defined(TINY_GSM_POLL_CHARS)
+#define TINY_GSM_POLL_CHARS 64
+#endif
+
+// The silence needed before and after the "+++" escape sequence
+#if !defined(TINY_GSM_ESCAPE_GUARD_MS)
+#define TINY_GSM_ESCAPE_GUARD_MS 1000
+#endif
+
+// Results reported by responseStatus() besides those of waitResponse
+#define TINY_GSM_RESPONSE_PENDING -1
+#define TINY_GSM_RESPONSE_UNKNOWN -2
+
+// Called when a command started with beginResponse() is done, with the
+// handle of the command and the result waitResponse would have returned
+typedef void (*TinyGsmResponseCallback)(uint8_t handle, int8_t result);
+
+// Flow control on the serial port between the host and the modem
+enum FlowControl {
+  FLOW_CONTROL_NONE   = 0,
+  FLOW_CONTROL_RTSCTS = 2,
+};
+
+// Switches the host's UART to the given flow control, returning whether it
+// could.  How depends on the board, e.g. setHwFlowCtrlMode() on an ESP32.
+typedef bool (*TinyGsmFlowControlHook)(FlowControl mode);
+
+// The command whose response the parser is waiting for
+struct TinyGsmCommand {
+  TinyGsmCommand()
+      : responses(), startMillis(0), timeout_ms(0), handle(0), active(false) {}
+
+  const char*    responses[6];
+  TinyGsmCapture data;
+  uint32_t       startMillis;
+  uint32_t       timeout_ms;
+  uint8_t        handle;  // 0 for blocking waitResponse calls
+  bool           active;
+};
 
 template <class modemType>
 class TinyGsmModem {
@@ -18,9 +115,10 @@ class TinyGsmModem {
    * Basic functions
    */
   bool begin(const char* pin = NULL) {
-    return thisModem().initImpl(pin);
+    return init(pin);
   }
   bool init(const char* pin = NULL) {
+    forgetSettings();  // The modem may have been reset meanwhile
     return thisModem().initImpl(pin);
   }
   template <typename... Args>
@@ -29,8 +127,40 @@ class TinyGsmModem {
     thisModem().stream.flush();
     TINY_GSM_YIELD(); /* DBG("### AT:", cmd...); */
   }
-  void setBaud(uint32_t baud) {
-    thisModem().setBaudImpl(baud);
+  // Sends a batch of AT commands, each given as the text following "AT",
+  // and waits for their final result codes, which are matched to the
+  // commands in order.  If given, results receives each command's result:
+  // 1 for OK, 2 for ERROR, 3 for +CME ERROR, 4 for +CMS ERROR or 0 if it
+  // timed out or wasn't sent.  With stopOnError, no more commands are sent
+  // after one fails.  Returns the number of commands that succeeded.
+  uint8_t sendATBatch(const GsmConstStr* cmds, uint8_t count,
+                      int8_t* results = NULL, uint32_t timeout_ms = 1000L,
+                      bool stopOnError = false) {
+    return thisModem().sendATBatchImpl(cmds, count, results, timeout_ms,
+                                       stopOnError);
+  }
+  // Sets the modem's side only, returning whether the modem took the rate
+  bool setBaud(uint32_t baud) {
+    return thisModem().setBaudImpl(baud);
+  }
+  // Moves the modem and the host's UART SerialAT from the current rate to the
+  // fastest rate up to target that works.  Each rate is checked with AT and
+  // the modem is switched back when it doesn't answer there.  Returns the
+  // rate in use afterwards, or 0 if the modem can't be reached any more.
+  // Rates above 115200 usually need hardware flow control.
+  template <typename S>
+  uint32_t negotiateBaud(S& SerialAT, uint32_t target,
+                         uint32_t current = 115200) {
+    return thisModem().negotiateBaudImpl(SerialAT, target, current);
+  }
+  // Sets the modem's flow control and then, through hostHook, the host's.
+  // If the host can't follow, the modem goes back to no flow control.
+  bool setFlowControl(FlowControl            mode,
+                      TinyGsmFlowControlHook hostHook = NULL) {
+    if (!thisModem().setFlowControlImpl(mode)) { return false; }
+    if (!hostHook || hostHook(mode)) { return true; }
+    thisModem().setFlowControlImpl(FLOW_CONTROL_NONE);
+    return false;
   }
   // Test response to AT commands
   bool testAT(uint32_t timeout_ms = 10000L) {
@@ -47,6 +177,7 @@ class TinyGsmModem {
     return thisModem().getModemNameImpl();
   }
   bool factoryDefault() {
+    forgetSettings();
     return thisModem().factoryDefaultImpl();
   }
 
@@ -54,9 +185,11 @@ class TinyGsmModem {
    * Power functions
    */
   bool restart(const char* pin = NULL) {
+    forgetSettings();
     return thisModem().restartImpl(pin);
   }
   bool poweroff() {
+    forgetSettings();
     return thisModem().powerOffImpl();
   }
   bool radioOff() {
@@ -84,6 +217,25 @@ class TinyGsmModem {
   int16_t getSignalQuality() {
     return thisModem().getSignalQualityImpl();
   }
+  // The registration status (as in +CREG) last reported by the modem or
+  // read by getRegistrationStatus(), preferring a registered one of CREG,
+  // CGREG and CEREG, or -1 if none is known.  Sends no command.
+  int8_t getCachedRegStatus() {
+    int8_t res = -1;
+    for (uint8_t i = 0; i < 3; i++) {
+      if (regStatus[i] == 1 || regStatus[i] == 5) { return regStatus[i]; }
+      if (regStatus[i] >= 0) { res = regStatus[i]; }
+    }
+    return res;
+  }
+  // The cell and location/tracking area of the last registration report
+  // that had them, or 0.  Sends no command.
+  uint32_t getCachedCellId() {
+    return regCellId;
+  }
+  uint32_t getCachedAreaCode() {
+    return regAreaCode;
+  }
   String getLocalIP() {
     return thisModem().getLocalIPImpl();
   }
@@ -91,6 +243,133 @@ class TinyGsmModem {
     return thisModem().TinyGsmIpFromString(thisModem().getLocalIP());
   }
 
+  /*
+   * Response parsing
+   */
+  // Waits for one of up to five responses, capturing everything received
+  // into data.  Returns the 1-based number of the response found, or 0 on
+  // timeout.  Any URC's received meanwhile are handled and dropped.
+  int8_t waitResponse(uint32_t timeout_ms, String& data,
+                      GsmConstStr r1 = GFP(GSM_OK),
+                      GsmConstStr r2 = GFP(GSM_ERROR),
+#if defined TINY_GSM_DEBUG
+                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
+                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
+#else
+                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
+#endif
+                      GsmConstStr r5 = NULL) {
+    data.reserve(64);
+    return thisModem().waitResponseImpl(timeout_ms, TinyGsmCapture(&data), r1,
+                                        r2, r3, r4, r5);
+  }
+
+  // As above, but captures into a fixed buffer instead of a String so no heap
+  // is used.  The buffer is always null terminated; anything that doesn't fit
+  // is dropped.
+  template <size_t N>
+  int8_t waitResponse(uint32_t timeout_ms, char (&buf)[N],
+                      GsmConstStr r1 = GFP(GSM_OK),
+                      GsmConstStr r2 = GFP(GSM_ERROR),
+#if defined TINY_GSM_DEBUG
+                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
+                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
+#else
+                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
+#endif
+                      GsmConstStr r5 = NULL) {
+    return thisModem().waitResponseImpl(timeout_ms, TinyGsmCapture(buf, N),
+                                        r1, r2, r3, r4, r5);
+  }
+
+  int8_t waitResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
+                      GsmConstStr r2 = GFP(GSM_ERROR),
+#if defined TINY_GSM_DEBUG
+                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
+                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
+#else
+                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
+#endif
+                      GsmConstStr r5 = NULL) {
+    return thisModem().waitResponseImpl(timeout_ms, TinyGsmCapture(), r1, r2,
+                                        r3, r4, r5);
+  }
+
+  int8_t waitResponse(GsmConstStr r1 = GFP(GSM_OK),
+                      GsmConstStr r2 = GFP(GSM_ERROR),
+#if defined TINY_GSM_DEBUG
+                      GsmConstStr r3 = GFP(GSM_CME_ERROR),
+                      GsmConstStr r4 = GFP(GSM_CMS_ERROR),
+#else
+                      GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
+#endif
+                      GsmConstStr r5 = NULL) {
+    return waitResponse(1000, r1, r2, r3, r4, r5);
+  }
+
+  /*
+   * Non-blocking response parsing
+   */
+  // Starts waiting for the response to a command already sent with sendAT,
+  // without blocking.  The response is parsed as poll() is called and its
+  // result is then available from responseStatus() and the response
+  // callback.  Returns a handle identifying the command.
+  // NOTE:  Only one command can be pending at a time and no blocking
+  // function may be called until it is done.
+  uint8_t beginResponse(uint32_t timeout_ms, GsmConstStr r1 = GFP(GSM_OK),
+                        GsmConstStr r2 = GFP(GSM_ERROR),
+#if defined TINY_GSM_DEBUG
+                        GsmConstStr r3 = GFP(GSM_CME_ERROR),
+                        GsmConstStr r4 = GFP(GSM_CMS_ERROR),
+#else
+                        GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
+#endif
+                        GsmConstStr r5 = NULL) {
+    return thisModem().beginResponseImpl(timeout_ms, TinyGsmCapture(), r1, r2,
+                                         r3, r4, r5);
+  }
+
+  // As above, capturing the response into buf, which must stay valid until
+  // the command is done
+  template <size_t N>
+  uint8_t beginResponse(uint32_t timeout_ms, char (&buf)[N],
+                        GsmConstStr r1 = GFP(GSM_OK),
+                        GsmConstStr r2 = GFP(GSM_ERROR),
+#if defined TINY_GSM_DEBUG
+                        GsmConstStr r3 = GFP(GSM_CME_ERROR),
+                        GsmConstStr r4 = GFP(GSM_CMS_ERROR),
+#else
+                        GsmConstStr r3 = NULL, GsmConstStr r4 = NULL,
+#endif
+                        GsmConstStr r5 = NULL) {
+    return thisModem().beginResponseImpl(timeout_ms, TinyGsmCapture(buf, N),
+                                         r1, r2, r3, r4, r5);
+  }
+
+  // Parses at most max_chars of the characters already received, handling
+  // any URC's, and times out the pending command if needed.  Never waits for
+  // more characters, though URC handlers still read the rest of their URC.
+  // Returns true while a command is pending.
+  bool poll(uint16_t max_chars = TINY_GSM_POLL_CHARS) {
+    thisModem().pollImpl(max_chars);
+    return command.active;
+  }
+
+  // Result of the command with the given handle: TINY_GSM_RESPONSE_PENDING,
+  // the 1-based number of the response received or 0 on timeout.  Only the
+  // latest command is remembered; older ones are TINY_GSM_RESPONSE_UNKNOWN.
+  int8_t responseStatus(uint8_t handle) const {
+    if (command.active && handle == command.handle) {
+      return TINY_GSM_RESPONSE_PENDING;
+    }
+    if (handle && handle == lastHandle) { return lastResult; }
+    return TINY_GSM_RESPONSE_UNKNOWN;
+  }
+
+  void setResponseCallback(TinyGsmResponseCallback callback) {
+    responseCallback = callback;
+  }
+
   /*
    * CRTP Helper
    */
@@ -102,13 +381,214 @@ class TinyGsmModem {
     return static_cast<modemType&>(*this);
   }
 
+  /*
+   * Response parsing
+   */
+ protected:
+  // Blocking parser, built on the same engine as beginResponse and poll
+  int8_t waitResponseImpl(uint32_t timeout_ms, TinyGsmCapture data,
+                          GsmConstStr r1, GsmConstStr r2, GsmConstStr r3,
+                          GsmConstStr r4, GsmConstStr r5,
+                          GsmConstStr r6 = NULL) {
+    // URC handlers may send commands of their own while one is pending
+    TinyGsmCommand outer = command;
+    startCommand(0, timeout_ms, data, r1, r2, r3, r4, r5, r6);
+    int8_t res;
+    do {
+      TINY_GSM_YIELD();
+      res = thisModem().pollImpl(0xFFFF);
+    } while (res == TINY_GSM_RESPONSE_PENDING);
+    command = outer;
+    return res;
+  }
+
+  uint8_t beginResponseImpl(uint32_t timeout_ms, TinyGsmCapture data,
+                            GsmConstStr r1, GsmConstStr r2, GsmConstStr r3,
+                            GsmConstStr r4, GsmConstStr r5) {
+    if (++nextHandle == 0) { nextHandle = 1; }
+    startCommand(nextHandle, timeout_ms, data, r1, r2, r3, r4, r5, NULL);
+    return nextHandle;
+  }
+
+  // Parses up to max_chars received characters.  Returns the result of the
+  // pending command once it is done, or TINY_GSM_RESPONSE_PENDING.
+  int8_t pollImpl(uint16_t max_chars) {
+    uint8_t     numUrcs = 0;
+    const auto* urcs    = thisModem().urcTable(numUrcs);
+    numUrcs = TinyGsmMin(numUrcs, static_cast<uint8_t>(TINY_GSM_URC_MAX));
+    if (!urcIndex.built()) { urcIndex.build(urcs, numUrcs); }
+
+    while (max_chars && thisModem().stream.available() > 0) {
+      TINY_GSM_YIELD();
+      int8_t a = thisModem().stream.read();
+      if (a <= 0) continue;  // Skip 0x00 bytes, just in case
+      max_chars--;
+      char c = static_cast<char>(a);
+      matcher.put(c);
+
+      // A modem that restarted by itself has lost its settings
+      if (c == 'Y' && matcher.endsWith(GSM_RDY)) { forgetSettings(); }
+
+      // Every response sees every character and the first one found wins;
+      // URC's are only checked when c can end one of them
+      uint8_t index = 0;
+      if (command.active) {
+        command.data.put(c);
+        for (uint8_t i = 0; i < 6; i++) {
+          if (matcher.step(i, command.responses[i], c) && !index) {
+            index = i + 1;
+          }
+        }
+      }
+      if (index) {
+#if defined TINY_GSM_DEBUG
+        if (index == 3 && command.responses[2] == GSM_CME_ERROR) {
+          thisModem().streamSkipUntil('\n');  // Read out the error
+        }
+#endif
+        return finishCommand(index);
+      }
+
+      // Registration reports are handled here for every modem while
+      // waitForNetwork() has them turned on, unless the pending command is
+      // partway through matching the line itself
+      if (c == ':' && regReports && !responseInProgress() &&
+          handleRegistration()) {
+        matcher.clear();
+        if (command.active) { command.data.clear(); }
+        continue;
+      }
+
+      uint16_t candidates = urcIndex.candidates(c);
+      for (uint8_t i = 0; candidates; i++, candidates >>= 1) {
+        if (!(candidates & 1) || !matcher.endsWith(urcs[i].prefix)) {
+          continue;
+        }
+        decltype(urcs->handle) handle;
+        TINY_GSM_MEMCPY_P(&handle, &urcs[i].handle, sizeof(handle));
+        if (callUrcHandler(thisModem(), handle)) {
+          matcher.clear();
+          if (command.active) { command.data.clear(); }
+        }
+        break;
+      }
+    }
+
+    if (!command.active) { return TINY_GSM_RESPONSE_UNKNOWN; }
+    if (millis() - command.startMillis < command.timeout_ms) {
+      return TINY_GSM_RESPONSE_PENDING;
+    }
+#if defined TINY_GSM_DEBUG
+    char   unhandled[TINY_GSM_RESPONSE_WINDOW + 1];
+    size_t len   = matcher.copyTo(unhandled, sizeof(unhandled));
+    char*  start = unhandled;
+    while (len && isspace(unhandled[len - 1])) { unhandled[--len] = '\0'; }
+    while (isspace(*start)) { start++; }
+    if (*start) { DBG("### Unhandled:", start); }
+#endif
+    command.data.clear();
+    return finishCommand(0);
+  }
+
+  void startCommand(uint8_t handle, uint32_t timeout_ms, TinyGsmCapture data,
+                    GsmConstStr r1, GsmConstStr r2, GsmConstStr r3,
+                    GsmConstStr r4, GsmConstStr r5, GsmConstStr r6) {
+    command.responses[0] = reinterpret_cast<const char*>(r1);
+    command.responses[1] = reinterpret_cast<const char*>(r2);
+    command.responses[2] = reinterpret_cast<const char*>(r3);
+    command.responses[3] = reinterpret_cast<const char*>(r4);
+    command.responses[4] = reinterpret_cast<const char*>(r5);
+    command.responses[5] = reinterpret_cast<const char*>(r6);
+    command.data         = data;
+    command.startMillis  = millis();
+    command.timeout_ms   = timeout_ms;
+    command.handle       = handle;
+    command.active       = true;
+    matcher.clear();
+  }
+
+  // Whether the characters just received are the start of one of the
+  // pending command's responses
+  bool responseInProgress() const {
+    if (!command.active) { return false; }
+    for (uint8_t i = 0; i < 6; i++) {
+      if (matcher.progress(i)) { return true; }
+    }
+    return false;
+  }
+
+  int8_t finishCommand(int8_t result) {
+    command.active = false;
+    command.data   = TinyGsmCapture();  // the buffer may not outlive us
+    if (command.handle) {
+      lastHandle = command.handle;
+      lastResult = result;
+      if (responseCallback) { responseCallback(lastHandle, result); }
+    }
+    return result;
+  }
+
+  // Drivers with no URC's to handle can rely on this empty table
+  const TinyGsmUrc<modemType>* urcTable(uint8_t& count) {
+    count = 0;
+    return NULL;
+  }
+
+  // Calls a URC handler declared by the modem, which may be a sub-class of
+  // the type this template was instantiated for
+  template <class T, class M>
+  static inline bool callUrcHandler(M& modem, bool (T::*handle)()) {
+    return (static_cast<T&>(modem).*handle)();
+  }
+
   /*
    * Basic functions
    */
  protected:
-  void setBaudImpl(uint32_t baud) {
+  bool setBaudImpl(uint32_t baud) {
     thisModem().sendAT(GF("+IPR="), baud);
-    thisModem().waitResponse();
+    return thisModem().waitResponse() == 1;
+  }
+
+  bool setFlowControlImpl(FlowControl mode) {
+    if (mode == FLOW_CONTROL_RTSCTS) {
+      thisModem().sendAT(GF("+IFC=2,2"));  // RTS for receiving, CTS for sending
+    } else {
+      thisModem().sendAT(GF("+IFC=0,0"));
+    }
+    return thisModem().waitResponse() == 1;
+  }
+
+  template <typename S>
+  uint32_t negotiateBaudImpl(S& SerialAT, uint32_t target, uint32_t current) {
+    static const uint32_t rates[] = {921600, 460800, 230400, 115200,
+                                     57600,  38400,  19200};
+    for (uint8_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+      uint32_t rate = rates[i];
+      if (rate > target || rate <= current) { continue; }
+      DBG("### Switching to baud rate", rate);
+      // The modem answers at the old rate, so a refusal leaves it there
+      if (!thisModem().setBaud(rate)) { continue; }
+      if (switchHostBaud(SerialAT, rate)) { return rate; }
+      // Usually only the replies are garbled at a rate that's too fast, so
+      // the modem still understands being switched back
+      thisModem().setBaud(current);
+      if (!switchHostBaud(SerialAT, current)) {
+        DBG("### Modem lost after trying", rate);
+        return 0;
+      }
+    }
+    return current;
+  }
+
+  // Moves the host's side to rate and checks that the modem answers there
+  template <typename S>
+  bool switchHostBaud(S& SerialAT, uint32_t rate) {
+    SerialAT.flush();
+    SerialAT.begin(rate);
+    delay(100);
+    thisModem().streamClear();
+    return thisModem().testAT(1000L);
   }
 
   bool testATImpl(uint32_t timeout_ms = 10000L) {
@@ -120,8 +600,75 @@ class TinyGsmModem {
     return false;
   }
 
+  // Sends a setting unless value is already known to be applied, returning
+  // whether it is
+  template <typename... Args>
+  bool sendATCached(TinyGsmSetting setting, int16_t value,
+                    uint32_t timeout_ms, Args... cmd) {
+    if (settings[setting] == value + 1) { return true; }
+    thisModem().sendAT(cmd...);
+    bool ok           = thisModem().waitResponse(timeout_ms) == 1;
+    settings[setting] = ok ? value + 1 : 0;
+    return ok;
+  }
+
+  void forgetSettings() {
+    memset(settings, 0, sizeof(settings));
+  }
+  void forgetSetting(TinyGsmSetting setting) {
+    settings[setting] = 0;
+  }
+
+  // Switches from a data connection back to AT commands with the guarded
+  // "+++" escape sequence.  Anything the modem sends meanwhile is lost.
+  bool escapeDataMode() {
+    thisModem().stream.flush();
+    delay(TINY_GSM_ESCAPE_GUARD_MS);
+    thisModem().stream.print(GF("+++"));
+    thisModem().stream.flush();
+    delay(TINY_GSM_ESCAPE_GUARD_MS);
+    thisModem().streamClear();
+    return thisModem().testAT();
+  }
+
+  uint8_t sendATBatchImpl(const GsmConstStr* cmds, uint8_t count,
+                          int8_t* results, uint32_t timeout_ms,
+                          bool stopOnError) {
+    uint8_t sent = 0;
+    uint8_t done = 0;
+    uint8_t ok   = 0;
+    bool    stop = false;
+    while (done < count) {
+      // Keep up to TINY_GSM_BATCH_DEPTH commands waiting for their results
+      while (!stop && sent < count && sent - done < TINY_GSM_BATCH_DEPTH) {
+        thisModem().streamWrite("AT", cmds[sent++], thisModem().gsmNL);
+      }
+      if (done == sent) { break; }
+      thisModem().stream.flush();
+
+      int8_t res = thisModem().waitResponse(
+          timeout_ms, GFP(GSM_OK), GFP(GSM_ERROR), GF(GSM_NL "+CME ERROR:"),
+          GF(GSM_NL "+CMS ERROR:"));
+      if (res == 3 || res == 4) {
+        thisModem().streamSkipUntil('\n');  // Read out the error
+      }
+      if (results) { results[done] = res; }
+      done++;
+      if (res == 1) {
+        ok++;
+      } else if (res == 0) {
+        break;  // Later results can't be matched to their commands any more
+      } else if (stopOnError) {
+        stop = true;
+      }
+    }
+    for (; results && done < count; done++) { results[done] = 0; }
+    return ok;
+  }
+
   String getModemInfoImpl() {
     thisModem().sendAT(GF("I"));
+    // ATI answers with several lines, often more than a fixed buffer holds
     String res;
     if (thisModem().waitResponse(1000L, res) != 1) { return ""; }
     // Do the replaces twice so we cover both \r and \r\n type endings
@@ -134,21 +681,15 @@ class TinyGsmModem {
   }
 
   String getModemNameImpl() {
+    char res[TINY_GSM_RESPONSE_BUFFER];
     thisModem().sendAT(GF("+CGMI"));
-    String res1;
-    if (thisModem().waitResponse(1000L, res1) != 1) { return "unknown"; }
-    res1.replace("\r\nOK\r\n", "");
-    res1.replace("\rOK\r", "");
-    res1.trim();
+    if (thisModem().waitResponse(1000L, res) != 1) { return "unknown"; }
+    String name = cleanResponse(res);
 
     thisModem().sendAT(GF("+GMM"));
-    String res2;
-    if (thisModem().waitResponse(1000L, res2) != 1) { return "unknown"; }
-    res2.replace("\r\nOK\r\n", "");
-    res2.replace("\rOK\r", "");
-    res2.trim();
-
-    String name = res1 + String(' ') + res2;
+    if (thisModem().waitResponse(1000L, res) != 1) { return "unknown"; }
+    name += ' ';
+    name += cleanResponse(res);
     DBG("### Modem:", name);
     return name;
   }
@@ -168,10 +709,40 @@ class TinyGsmModem {
  protected:
   bool radioOffImpl() {
     if (!thisModem().setPhoneFunctionality(0)) { return false; }
-    delay(3000);
+    waitForFunctionality(0, 3000L);
     return true;
   }
 
+  // Waits for a restarting modem to be back, for at most timeout_ms: until
+  // it sends one of its boot messages, or answers an AT after having stopped
+  // answering, as it may still answer the first ones before going down
+  bool waitForRestart(uint32_t timeout_ms) {
+    bool gone = false;
+    for (uint32_t start = millis(); millis() - start < timeout_ms;) {
+      thisModem().sendAT(GF(""));
+      int8_t res = thisModem().waitResponse(
+          200L, GFP(GSM_OK), GF("RDY"), GF("+CPIN: READY"), GF("SMS Ready"),
+          GF("+CFUN: 1"));
+      if (res > 1 || (res == 1 && gone)) { return true; }
+      if (res == 0) { gone = true; }
+    }
+    return false;
+  }
+
+  // Waits for +CFUN? to report fun, for at most timeout_ms
+  bool waitForFunctionality(uint8_t fun, uint32_t timeout_ms) {
+    for (uint32_t start = millis(); millis() - start < timeout_ms;) {
+      thisModem().sendAT(GF("+CFUN?"));
+      if (thisModem().waitResponse(GF("+CFUN:")) == 1) {
+        int16_t res = thisModem().streamGetIntBefore('\n');
+        thisModem().waitResponse();
+        if (res == fun) { return true; }
+      }
+      delay(100);
+    }
+    return false;
+  }
+
   bool sleepEnableImpl(bool enable = true) TINY_GSM_ATTR_NOT_IMPLEMENTED;
 
   bool setPhoneFunctionalityImpl(uint8_t fun, bool reset = false)
@@ -186,25 +757,143 @@ class TinyGsmModem {
   // CGREG = GPRS service registration
   // CEREG = EPS registration for LTE modules
   int8_t getRegistrationStatusXREG(const char* regCommand) {
+    uint8_t type = regType(regCommand);
     thisModem().sendAT('+', regCommand, '?');
-    // check for any of the three for simplicity
-    int8_t resp = thisModem().waitResponse(GF("+CREG:"), GF("+CGREG:"),
-                                           GF("+CEREG:"));
-    if (resp != 1 && resp != 2 && resp != 3) { return -1; }
+    // Only this command's answer; a report of another one may come first
+    if (thisModem().waitResponse(regPrefix(type), GFP(GSM_ERROR)) != 1) {
+      return -1;
+    }
     thisModem().streamSkipUntil(','); /* Skip format (0) */
     int status = thisModem().stream.parseInt();
     thisModem().waitResponse();
+    regStatus[type] = status;
     return status;
   }
 
+  // Once registration reports are on, the wait ends as soon as one reports
+  // a registration, and the status is only queried now and then.  They are
+  // only turned on when the modem isn't registered already, and set back to
+  // what they were afterwards.
   bool waitForNetworkImpl(uint32_t timeout_ms   = 60000L,
                           bool     check_signal = false) {
-    for (uint32_t start = millis(); millis() - start < timeout_ms;) {
-      if (check_signal) { thisModem().getSignalQuality(); }
-      if (thisModem().isNetworkConnected()) { return true; }
-      delay(250);
+    if (check_signal) { thisModem().getSignalQuality(); }
+    if (thisModem().isNetworkConnected()) { return true; }
+
+    int8_t   levels[3] = {-1, -1, -1};
+    uint32_t interval  = thisModem().enableRegistrationReportsImpl(levels)
+                             ? TINY_GSM_REG_POLL_MS
+                             : 250;
+    uint32_t start     = millis();
+    uint32_t lastQuery = millis();
+    bool     res       = false;
+    regReported        = false;
+    while (millis() - start < timeout_ms) {
+      thisModem().poll();
+      TINY_GSM_YIELD();
+      if (regReported || millis() - lastQuery >= interval) {
+        regReported = false;
+        if (check_signal) { thisModem().getSignalQuality(); }
+        res       = thisModem().isNetworkConnected();
+        lastQuery = millis();
+        if (res) { break; }
+      }
     }
-    return false;
+    thisModem().restoreRegistrationReportsImpl(levels);
+    return res;
+  }
+
+  // Turns on the +CREG/+CGREG/+CEREG reports with the cell, keeping the
+  // report level each had in levels, or -1 for those the modem hasn't got.
+  // Returns false if the modem has none of them.
+  bool enableRegistrationReportsImpl(int8_t* levels) {
+    levels[0] = enableRegistrationReports("CREG");
+    levels[1] = enableRegistrationReports("CGREG");
+    levels[2] = enableRegistrationReports("CEREG");
+    regReports = levels[0] >= 0 || levels[1] >= 0 || levels[2] >= 0;
+    return regReports;
+  }
+
+  // Puts back the report levels enableRegistrationReportsImpl() replaced
+  void restoreRegistrationReportsImpl(const int8_t* levels) {
+    regReports = false;
+    if (levels[0] >= 0 && levels[0] != 2) {
+      thisModem().sendAT(GF("+CREG="), static_cast<int>(levels[0]));
+      thisModem().waitResponse();
+    }
+    if (levels[1] >= 0 && levels[1] != 2) {
+      thisModem().sendAT(GF("+CGREG="), static_cast<int>(levels[1]));
+      thisModem().waitResponse();
+    }
+    if (levels[2] >= 0 && levels[2] != 2) {
+      thisModem().sendAT(GF("+CEREG="), static_cast<int>(levels[2]));
+      thisModem().waitResponse();
+    }
+  }
+
+  // Sets the report level <n> of CREG, CGREG or CEREG to 2, returning the
+  // one it had, or -1 if the modem hasn't got the command
+  int8_t enableRegistrationReports(const char* regCommand) {
+    thisModem().sendAT('+', regCommand, '?');
+    if (thisModem().waitResponse(regPrefix(regType(regCommand)),
+                                 GFP(GSM_ERROR)) != 1) {
+      return -1;
+    }
+    int8_t old = thisModem().streamGetIntBefore(',');
+    thisModem().waitResponse();
+    if (old == 2) { return old; }
+    thisModem().sendAT('+', regCommand, GF("=2"));
+    if (thisModem().waitResponse() != 1) { return -1; }
+    return old;
+  }
+
+  // The index into regStatus of CREG, CGREG or CEREG, and its answer's prefix
+  static uint8_t regType(const char* regCommand) {
+    if (!strcmp(regCommand, "CGREG")) { return 1; }
+    if (!strcmp(regCommand, "CEREG")) { return 2; }
+    return 0;
+  }
+  static GsmConstStr regPrefix(uint8_t type) {
+    if (type == 1) { return GFP(GSM_CGREG); }
+    if (type == 2) { return GFP(GSM_CEREG); }
+    return GFP(GSM_CREG);
+  }
+
+  // Reads a registration report into the cache, once the matcher has just
+  // received its prefix: <stat>[,<lac>,<ci>[,<AcT>]].  Only called while
+  // the reports are on, when every query's answer is taken by the command
+  // waiting for it, so the line never starts with <n>.
+  bool handleRegistration() {
+    uint8_t type;
+    if (matcher.endsWith(GSM_CREG)) {
+      type = 0;
+    } else if (matcher.endsWith(GSM_CGREG)) {
+      type = 1;
+    } else if (matcher.endsWith(GSM_CEREG)) {
+      type = 2;
+    } else {
+      return false;
+    }
+    char   line[48];
+    size_t len = thisModem().stream.readBytesUntil('\n', line,
+                                                   sizeof(line) - 1);
+    line[len]  = '\0';
+    char* p    = line;
+    int   stat = atoi(p);
+    p          = strchr(p, ',');
+
+    regStatus[type] = stat;
+    if (stat == 1 || stat == 5) {
+      regReported = true;
+      // Both are hexadecimal and usually quoted
+      char* cell = p ? strchr(p + 1, ',') : NULL;
+      if (cell) {
+        while (*p && !isxdigit(*p)) { p++; }
+        while (*cell && !isxdigit(*cell)) { cell++; }
+        regAreaCode = strtoul(p, NULL, 16);
+        regCellId   = strtoul(cell, NULL, 16);
+      }
+    }
+    return true;
   }
 
   // Gets signal quality report according to 3GPP TS command AT+CSQ
@@ -269,6 +958,35 @@ class TinyGsmModem {
   }
 
  protected:
+  // Tidies up a response captured into buf by waitResponse: drops the final
+  // OK, replaces each line break (\r or \r\n) with sep, or removes it if sep
+  // is '\0', and trims the surrounding white space.  Works in place and
+  // returns the start of the remaining text.
+  static char* cleanResponse(char* buf, char sep = ' ') {
+    char* end = buf + strlen(buf);
+    while (end > buf && isspace(end[-1])) { end--; }
+    if (end - buf >= 2 && end[-2] == 'O' && end[-1] == 'K' &&
+        (end - buf == 2 || end[-3] == '\r' || end[-3] == '\n')) {
+      end -= 2;
+      while (end > buf && isspace(end[-1])) { end--; }
+    }
+    *end = '\0';
+
+    char* start = buf;
+    while (isspace(*start)) { start++; }
+    char* out = start;
+    for (char* in = start; *in; in++) {
+      if (*in == '\r' || *in == '\n') {
+        if (*in == '\r' && in[1] == '\n') { in++; }
+        if (sep) { *out++ = sep; }
+      } else {
+        *out++ = *in;
+      }
+    }
+    *out = '\0';
+    return start;
+  }
+
   inline bool streamGetLength(char* buf, int8_t numChars,
                               const uint32_t timeout_ms = 1000L) {
     if (!buf) { return false; }
@@ -313,6 +1031,17 @@ class TinyGsmModem {
     return -9999;
   }
 
+  // Reads everything before lastChar into buf as a null terminated string,
+  // dropping whatever doesn't fit.  Returns the length kept.
+  inline size_t streamGetStringBefore(char lastChar, char* buf, size_t size) {
+    if (!buf || !size) { return 0; }
+    size_t len = thisModem().stream.readBytesUntil(lastChar, buf, size - 1);
+    buf[len]   = '\0';
+    // A full buffer means lastChar hasn't been read yet
+    if (len == size - 1) { streamSkipUntil(lastChar); }
+    return len;
+  }
+
   inline float streamGetFloatLength(int8_t         numChars,
                                     const uint32_t timeout_ms = 1000L) {
     char buf[numChars + 1];
@@ -349,6 +1078,29 @@ class TinyGsmModem {
     }
     return false;
   }
+
+ protected:
+  static_assert(TINY_GSM_RESPONSE_WINDOW >=
+                    sizeof(TinyGsmUrc<modemType>::prefix),
+                "TINY_GSM_RESPONSE_WINDOW must hold the longest URC prefix");
+
+  TinyGsmMatcher<TINY_GSM_RESPONSE_WINDOW, 6> matcher;
+  TinyGsmUrcIndex<TINY_GSM_URC_MAX>           urcIndex;
+  TinyGsmCommand                              command;
+  TinyGsmResponseCallback                     responseCallback = NULL;
+  uint8_t                                     nextHandle       = 0;
+  uint8_t                                     lastHandle       = 0;
+  int8_t                                      lastResult       = 0;
+
+  // The applied value of each setting plus one, 0 if unknown
+  int16_t settings[SETTING_COUNT] = {};
+
+  // Registration cache, see getCachedRegStatus()
+  int8_t   regStatus[3] = {-1, -1, -1};  // CREG, CGREG, CEREG
+  uint32_t regCellId    = 0;
+  uint32_t regAreaCode  = 0;
+  bool     regReported  = false;
+  bool     regReports   = false;  // Turned on by waitForNetwork()
 };
 
 #endif  // SRC_TINYGSMMODEM_H_
@@ -0,0 +1,549 @@
+/**
+ * @file       TinyGsmMux.h
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Nov 2016
+ */
+
+#ifndef SRC_TINYGSMMUX_H_
+#define SRC_TINYGSMMUX_H_
+
+#include "TinyGsmCommon.h"
+#include "TinyGsmFifo.h"
+
+// The number of data channels (DLCI 1 to TINY_GSM_MUX_CHANNELS)
+#if !defined(TINY_GSM_MUX_CHANNELS)
+#define TINY_GSM_MUX_CHANNELS 2
+#endif
+
+// The largest frame payload, which must not be more than the N1 given in
+// AT+CMUX (31 unless set there).  Longer received frames are dropped.
+#if !defined(TINY_GSM_MUX_FRAME)
+#define TINY_GSM_MUX_FRAME 31
+#endif
+
+// The receive buffer of each channel, best a power of two
+#if !defined(TINY_GSM_MUX_RX_BUFFER)
+#define TINY_GSM_MUX_RX_BUFFER 128
+#endif
+
+// How much room may be left in a channel's receive buffer before the modem
+// is asked, through the flow control bit of an MSC, to stop sending on that
+// channel.  Whatever it sends before it sees that still has to fit, so this
+// is best a couple of frames.  It may send again once a frame more is free.
+#if !defined(TINY_GSM_MUX_RX_STOP)
+#define TINY_GSM_MUX_RX_STOP (2 * TINY_GSM_MUX_FRAME)
+#endif
+
+#if TINY_GSM_MUX_RX_BUFFER <= TINY_GSM_MUX_RX_STOP + TINY_GSM_MUX_FRAME
+#error TINY_GSM_MUX_RX_BUFFER is too small for TINY_GSM_MUX_RX_STOP
+#endif
+
+// FCS lookup table for the reversed polynomial x^8 + x^2 + x + 1
+static const uint8_t TinyGsmMuxFcsTable[256] TINY_GSM_PROGMEM = {
+    0x00, 0x91, 0xE3, 0x72, 0x07, 0x96, 0xE4, 0x75, 0x0E, 0x9F, 0xED, 0x7C,
+    0x09, 0x98, 0xEA, 0x7B, 0x1C, 0x8D, 0xFF, 0x6E, 0x1B, 0x8A, 0xF8, 0x69,
+    0x12, 0x83, 0xF1, 0x60, 0x15, 0x84, 0xF6, 0x67, 0x38, 0xA9, 0xDB, 0x4A,
+    0x3F, 0xAE, 0xDC, 0x4D, 0x36, 0xA7, 0xD5, 0x44, 0x31, 0xA0, 0xD2, 0x43,
+    0x24, 0xB5, 0xC7, 0x56, 0x23, 0xB2, 0xC0, 0x51, 0x2A, 0xBB, 0xC9, 0x58,
+    0x2D, 0xBC, 0xCE, 0x5F, 0x70, 0xE1, 0x93, 0x02, 0x77, 0xE6, 0x94, 0x05,
+    0x7E, 0xEF, 0x9D, 0x0C, 0x79, 0xE8, 0x9A, 0x0B, 0x6C, 0xFD, 0x8F, 0x1E,
+    0x6B, 0xFA, 0x88, 0x19, 0x62, 0xF3, 0x81, 0x10, 0x65, 0xF4, 0x86, 0x17,
+    0x48, 0xD9, 0xAB, 0x3A, 0x4F, 0xDE, 0xAC, 0x3D, 0x46, 0xD7, 0xA5, 0x34,
+    0x41, 0xD0, 0xA2, 0x33, 0x54, 0xC5, 0xB7, 0x26, 0x53, 0xC2, 0xB0, 0x21,
+    0x5A, 0xCB, 0xB9, 0x28, 0x5D, 0xCC, 0xBE, 0x2F, 0xE0, 0x71, 0x03, 0x92,
+    0xE7, 0x76, 0x04, 0x95, 0xEE, 0x7F, 0x0D, 0x9C, 0xE9, 0x78, 0x0A, 0x9B,
+    0xFC, 0x6D, 0x1F, 0x8E, 0xFB, 0x6A, 0x18, 0x89, 0xF2, 0x63, 0x11, 0x80,
+    0xF5, 0x64, 0x16, 0x87, 0xD8, 0x49, 0x3B, 0xAA, 0xDF, 0x4E, 0x3C, 0xAD,
+    0xD6, 0x47, 0x35, 0xA4, 0xD1, 0x40, 0x32, 0xA3, 0xC4, 0x55, 0x27, 0xB6,
+    0xC3, 0x52, 0x20, 0xB1, 0xCA, 0x5B, 0x29, 0xB8, 0xCD, 0x5C, 0x2E, 0xBF,
+    0x90, 0x01, 0x73, 0xE2, 0x97, 0x06, 0x74, 0xE5, 0x9E, 0x0F, 0x7D, 0xEC,
+    0x99, 0x08, 0x7A, 0xEB, 0x8C, 0x1D, 0x6F, 0xFE, 0x8B, 0x1A, 0x68, 0xF9,
+    0x82, 0x13, 0x61, 0xF0, 0x85, 0x14, 0x66, 0xF7, 0xA8, 0x39, 0x4B, 0xDA,
+    0xAF, 0x3E, 0x4C, 0xDD, 0xA6, 0x37, 0x45, 0xD4, 0xA1, 0x30, 0x42, 0xD3,
+    0xB4, 0x25, 0x57, 0xC6, 0xB3, 0x22, 0x50, 0xC1, 0xBA, 0x2B, 0x59, 0xC8,
+    0xBD, 0x2C, 0x5E, 0xCF};
+
+class TinyGsmMux;
+
+// One virtual serial port of the multiplexer.  Writes are collected into
+// frames, which are sent once full, on flush(), or before the channel is read
+// so that a command is always out before its response is waited for.
+class TinyGsmMuxChannel : public Stream {
+  friend class TinyGsmMux;
+
+ public:
+  TinyGsmMuxChannel() : mux(NULL), dlci(0), tx_len(0) {}
+
+  size_t write(const uint8_t* buf, size_t size) override;
+  size_t write(uint8_t c) override {
+    return write(&c, 1);
+  }
+  using Print::write;
+
+  int  available() override;
+  int  read() override;
+  int  peek() override;
+  void flush();
+
+ private:
+  void sendPending();
+
+  TinyGsmMux*                                   mux;
+  uint8_t                                       dlci;
+  TinyGsmFifo<uint8_t, TINY_GSM_MUX_RX_BUFFER> rx;
+  uint8_t                                       tx[TINY_GSM_MUX_FRAME];
+  uint8_t                                       tx_len;
+};
+
+// 3GPP TS 27.010 (GSM 07.10) basic option multiplexer.
+//
+// Runs several virtual serial ports over the one to the modem, so that e.g.
+// one TinyGsm instance can keep sending AT commands on channel 1 while the
+// data of a transparent connection or the GPS' NMEA flows on channel 2.
+// Once the modem has been switched over with AT+CMUX=0 nothing but frames may
+// be written to the real port:
+//
+//   modem.sendAT(GF("+CMUX=0"));
+//   modem.waitResponse();
+//   mux.begin();
+//   TinyGsm control(mux.channel(1));
+//
+// The multiplexer doesn't run on its own: everything received is sorted into
+// the channels whenever any channel is read, or when poll() is called.  A
+// channel whose buffer is almost full is paused until it has been read, so
+// the modem keeps the data; only what doesn't fit anyway is dropped.
+class TinyGsmMux {
+  friend class TinyGsmMuxChannel;
+
+ public:
+  explicit TinyGsmMux(Stream& stream) : stream(stream) {
+    for (uint8_t i = 0; i < TINY_GSM_MUX_CHANNELS; i++) {
+      channels[i].mux  = this;
+      channels[i].dlci = i + 1;
+    }
+    clear();
+  }
+
+  /*
+   * Basic functions
+   */
+  // Opens the control channel and then the first count data channels
+  bool begin(uint8_t  count      = TINY_GSM_MUX_CHANNELS,
+             uint32_t timeout_ms = 3000L) {
+    clear();
+    if (!open(0, timeout_ms)) { return false; }
+    for (uint8_t i = 1; i <= count && i <= TINY_GSM_MUX_CHANNELS; i++) {
+      if (!open(i, timeout_ms)) { return false; }
+    }
+    return true;
+  }
+
+  // Closes the multiplexer, after which the modem is back to plain AT
+  // commands on the real port
+  void end(uint32_t timeout_ms = 3000L) {
+    if (state[0] != MUX_OPEN) { return; }
+    for (uint8_t i = 1; i <= TINY_GSM_MUX_CHANNELS; i++) {
+      if (state[i] == MUX_OPEN) { channels[i - 1].sendPending(); }
+    }
+    state[0] = MUX_CLOSING;
+    sendControl(MSG_CLD | MSG_CR, NULL, 0);
+    waitState(0, timeout_ms);
+    clear();
+  }
+
+  TinyGsmMuxChannel& channel(uint8_t dlci) {
+    if (dlci < 1 || dlci > TINY_GSM_MUX_CHANNELS) { dlci = 1; }
+    return channels[dlci - 1];
+  }
+
+  // Opens a single channel, 0 being the control channel which must be opened
+  // before any other
+  bool open(uint8_t dlci, uint32_t timeout_ms = 3000L) {
+    if (dlci > TINY_GSM_MUX_CHANNELS) { return false; }
+    if (state[dlci] == MUX_OPEN) { return true; }
+    state[dlci] = MUX_OPENING;
+    sendFrame(dlci, FRAME_SABM | FRAME_PF, NULL, 0, true);
+    waitState(dlci, timeout_ms);
+    if (state[dlci] != MUX_OPEN) {
+      state[dlci] = MUX_CLOSED;
+      return false;
+    }
+    // Raise RTC and RTR, as some modems hold data back until they are
+    if (dlci) {
+      paused[dlci] = false;
+      sendModemStatus(dlci);
+    }
+    return true;
+  }
+
+  void close(uint8_t dlci, uint32_t timeout_ms = 3000L) {
+    if (dlci > TINY_GSM_MUX_CHANNELS || state[dlci] != MUX_OPEN) { return; }
+    if (dlci) { channels[dlci - 1].sendPending(); }
+    state[dlci] = MUX_CLOSING;
+    sendFrame(dlci, FRAME_DISC | FRAME_PF, NULL, 0, true);
+    waitState(dlci, timeout_ms);
+    state[dlci] = MUX_CLOSED;
+  }
+
+  bool isOpen(uint8_t dlci) const {
+    return dlci <= TINY_GSM_MUX_CHANNELS && state[dlci] == MUX_OPEN;
+  }
+
+  // Sorts everything received so far into the channels
+  void poll() {
+    uint8_t buf[16];
+    int     n;
+    while ((n = stream.available()) > 0) {
+      n = stream.readBytes(buf,
+                           TinyGsmMin(static_cast<size_t>(n), sizeof(buf)));
+      if (n <= 0) { break; }
+      for (int i = 0; i < n; i++) { rxByte(buf[i]); }
+    }
+  }
+
+  // Frames dropped for a bad FCS, a missing flag or being too long
+  uint16_t badFrames() const {
+    return bad_frames;
+  }
+  // Received data dropped because a channel's buffer was full, i.e. sent
+  // after the channel had been paused
+  uint16_t droppedBytes() const {
+    return dropped_bytes;
+  }
+
+  // FCS over n bytes, as sent after them
+  static uint8_t fcs(const uint8_t* p, size_t n) {
+    uint8_t f = 0xFF;
+    while (n--) { f = fcsStep(f, *p++); }
+    return 0xFF - f;
+  }
+
+ private:
+  enum {
+    MUX_FLAG = 0xF9,
+    MUX_EA   = 0x01,
+    MUX_CR   = 0x02,
+    // Control field values
+    FRAME_SABM = 0x2F,
+    FRAME_UA   = 0x63,
+    FRAME_DM   = 0x0F,
+    FRAME_DISC = 0x43,
+    FRAME_UIH  = 0xEF,
+    FRAME_UI   = 0x03,
+    FRAME_PF   = 0x10,
+    // Control channel message types, with EA set
+    MSG_CR    = 0x02,
+    MSG_PSC   = 0x41,
+    MSG_CLD   = 0xC1,
+    MSG_TEST  = 0x21,
+    MSG_FCON  = 0xA1,
+    MSG_FCOFF = 0x61,
+    MSG_MSC   = 0xE1,
+    MSG_NSC   = 0x11,
+    // MSC control signals, with EA set
+    MSC_FC  = 0x02,
+    MSC_RTC = 0x04,
+    MSC_RTR = 0x08,
+    MSC_DV  = 0x80,
+    // The good FCS residue, over the checked bytes and the FCS itself
+    FCS_GOOD = 0xCF
+  };
+
+  enum { MUX_CLOSED, MUX_OPENING, MUX_OPEN, MUX_CLOSING };
+
+  enum { RX_FLAG, RX_ADDR, RX_CTRL, RX_LEN, RX_LEN2, RX_DATA, RX_FCS, RX_END };
+
+  static uint8_t fcsStep(uint8_t f, uint8_t c) {
+    return TINY_GSM_PGM_BYTE(&TinyGsmMuxFcsTable[f ^ c]);
+  }
+
+  void clear() {
+    memset(state, MUX_CLOSED, sizeof(state));
+    memset(held, 0, sizeof(held));
+    memset(paused, 0, sizeof(paused));
+    rx_state = RX_FLAG;
+    for (uint8_t i = 0; i < TINY_GSM_MUX_CHANNELS; i++) {
+      channels[i].rx.clear();
+      channels[i].tx_len = 0;
+    }
+  }
+
+  // Polls until the channel has left MUX_OPENING or MUX_CLOSING
+  void waitState(uint8_t dlci, uint32_t timeout_ms) {
+    uint32_t startMillis = millis();
+    while ((state[dlci] == MUX_OPENING || state[dlci] == MUX_CLOSING) &&
+           millis() - startMillis < timeout_ms) {
+      poll();
+      TINY_GSM_YIELD();
+    }
+  }
+
+  // Whether the modem has asked for data to be held back on a channel
+  bool isHeld(uint8_t dlci) const {
+    return held[0] || held[dlci];
+  }
+
+  void sendFrame(uint8_t dlci, uint8_t control, const uint8_t* data,
+                 size_t len, bool command) {
+    uint8_t head[5];
+    uint8_t n = 0;
+    head[n++] = MUX_FLAG;
+    head[n++] = (dlci << 2) | (command ? MUX_CR : 0) | MUX_EA;
+    head[n++] = control;
+    if (len > 127) {
+      head[n++] = static_cast<uint8_t>(len << 1);
+      head[n++] = static_cast<uint8_t>(len >> 7);
+    } else {
+      head[n++] = static_cast<uint8_t>(len << 1) | MUX_EA;
+    }
+    // UIH frames are only checked over their header
+    uint8_t tail[2] = {fcs(head + 1, n - 1), MUX_FLAG};
+    stream.write(head, n);
+    if (len) { stream.write(data, len); }
+    stream.write(tail, 2);
+  }
+
+  void sendControl(uint8_t type, const uint8_t* value, uint8_t len) {
+    uint8_t msg[2 + TINY_GSM_MUX_FRAME];
+    if (len > TINY_GSM_MUX_FRAME - 2) { len = TINY_GSM_MUX_FRAME - 2; }
+    msg[0] = type;
+    msg[1] = (len << 1) | MUX_EA;
+    if (len) { memcpy(msg + 2, value, len); }
+    sendFrame(0, FRAME_UIH, msg, len + 2, true);
+  }
+
+  // Sends a channel's V.24 signals, with the flow control bit set while the
+  // channel is paused
+  void sendModemStatus(uint8_t dlci) {
+    uint8_t msc[2] = {
+        static_cast<uint8_t>((dlci << 2) | MUX_CR | MUX_EA),
+        static_cast<uint8_t>(MSC_DV | MSC_RTR | MSC_RTC | MUX_EA |
+                             (paused[dlci] ? MSC_FC : 0))};
+    sendControl(MSG_MSC | MSG_CR, msc, sizeof(msc));
+  }
+
+  // Pauses the modem's sending on a channel once its buffer is almost full,
+  // and lets it go on when there is room again
+  void updateFlow(uint8_t dlci) {
+    int  room  = channels[dlci - 1].rx.free();
+    bool pause = room < TINY_GSM_MUX_RX_STOP +
+                            (paused[dlci] ? TINY_GSM_MUX_FRAME : 0);
+    if (pause == paused[dlci] || state[dlci] != MUX_OPEN) { return; }
+    paused[dlci] = pause;
+    sendModemStatus(dlci);
+  }
+
+  void rxByte(uint8_t c) {
+    switch (rx_state) {
+      case RX_FLAG:
+        if (c == MUX_FLAG) { rx_state = RX_ADDR; }
+        break;
+      case RX_ADDR:
+        if (c == MUX_FLAG) { break; }  // Between frames
+        rx_addr  = c;
+        rx_fcs   = fcsStep(0xFF, c);
+        rx_state = RX_CTRL;
+        break;
+      case RX_CTRL:
+        rx_ctrl  = c;
+        rx_fcs   = fcsStep(rx_fcs, c);
+        rx_state = RX_LEN;
+        break;
+      case RX_LEN:
+        rx_fcs   = fcsStep(rx_fcs, c);
+        rx_len   = c >> 1;
+        rx_pos   = 0;
+        rx_state = (c & MUX_EA) ? (rx_len ? RX_DATA : RX_FCS) : RX_LEN2;
+        break;
+      case RX_LEN2:
+        rx_fcs = fcsStep(rx_fcs, c);
+        rx_len |= static_cast<uint16_t>(c) << 7;
+        rx_state = rx_len ? RX_DATA : RX_FCS;
+        break;
+      case RX_DATA:
+        if (rx_pos < TINY_GSM_MUX_FRAME) { rx_frame[rx_pos] = c; }
+        // Only UI frames are checked over their data too
+        if ((rx_ctrl & ~FRAME_PF) == FRAME_UI) { rx_fcs = fcsStep(rx_fcs, c); }
+        if (++rx_pos == rx_len) { rx_state = RX_FCS; }
+        break;
+      case RX_FCS:
+        rx_fcs   = fcsStep(rx_fcs, c);
+        rx_state = RX_END;
+        break;
+      case RX_END:
+        if (c != MUX_FLAG) {
+          bad_frames++;
+          rx_state = RX_FLAG;
+          break;
+        }
+        if (rx_fcs == FCS_GOOD && rx_len <= TINY_GSM_MUX_FRAME) {
+          handleFrame();
+        } else {
+          bad_frames++;
+        }
+        rx_state = RX_ADDR;  // The closing flag may also open the next one
+        break;
+    }
+  }
+
+  void handleFrame() {
+    uint8_t dlci = rx_addr >> 2;
+    if (dlci > TINY_GSM_MUX_CHANNELS) {
+      if ((rx_ctrl & ~FRAME_PF) == FRAME_SABM) {
+        sendFrame(dlci, FRAME_DM | FRAME_PF, NULL, 0, false);
+      }
+      return;
+    }
+    switch (rx_ctrl & ~FRAME_PF) {
+      case FRAME_UA:
+        if (state[dlci] == MUX_OPENING) {
+          state[dlci] = MUX_OPEN;
+        } else if (state[dlci] == MUX_CLOSING) {
+          state[dlci] = MUX_CLOSED;
+        }
+        break;
+      case FRAME_DM: state[dlci] = MUX_CLOSED; break;
+      case FRAME_SABM:
+        sendFrame(dlci, FRAME_UA | FRAME_PF, NULL, 0, false);
+        state[dlci] = MUX_OPEN;
+        break;
+      case FRAME_DISC:
+        sendFrame(dlci, FRAME_UA | FRAME_PF, NULL, 0, false);
+        state[dlci] = MUX_CLOSED;
+        break;
+      case FRAME_UIH:
+      case FRAME_UI:
+        if (dlci == 0) {
+          handleControl(rx_frame, rx_len);
+        } else {
+          dropped_bytes += rx_len -
+                           channels[dlci - 1].rx.put(rx_frame, rx_len, false);
+          updateFlow(dlci);
+        }
+        break;
+    }
+  }
+
+  // Answers the messages on the control channel
+  void handleControl(const uint8_t* p, size_t n) {
+    while (n >= 2) {
+      uint8_t type = p[0];
+      size_t  len  = p[1] >> 1;
+      size_t  head = 2;
+      if (!(p[1] & MUX_EA)) {
+        if (n < 3) { return; }
+        len |= static_cast<size_t>(p[2]) << 7;
+        head = 3;
+      }
+      if (head + len > n) { return; }
+      const uint8_t* value = p + head;
+
+      if (!(type & MSG_CR)) {
+        // A response to one of ours
+        if ((type & ~MSG_CR) == MSG_CLD && state[0] == MUX_CLOSING) {
+          state[0] = MUX_CLOSED;
+        }
+      } else {
+        switch (type & ~MSG_CR) {
+          case MSG_MSC:
+            // Flow control bit of one channel
+            if (len >= 2 && (value[0] >> 2) <= TINY_GSM_MUX_CHANNELS) {
+              held[value[0] >> 2] = value[1] & 0x02;
+            }
+            sendControl(type & ~MSG_CR, value, len);
+            break;
+          case MSG_FCON:
+          case MSG_FCOFF:
+            held[0] = (type & ~MSG_CR) == MSG_FCOFF;
+            sendControl(type & ~MSG_CR, NULL, 0);
+            break;
+          case MSG_TEST:
+          case MSG_PSC: sendControl(type & ~MSG_CR, value, len); break;
+          case MSG_CLD:
+            sendControl(type & ~MSG_CR, NULL, 0);
+            memset(state, MUX_CLOSED, sizeof(state));
+            break;
+          default: sendControl(MSG_NSC, &type, 1); break;
+        }
+      }
+      p += head + len;
+      n -= head + len;
+    }
+  }
+
+  Stream&           stream;
+  TinyGsmMuxChannel channels[TINY_GSM_MUX_CHANNELS];
+  uint8_t           state[TINY_GSM_MUX_CHANNELS + 1];
+  bool              held[TINY_GSM_MUX_CHANNELS + 1];
+  bool              paused[TINY_GSM_MUX_CHANNELS + 1];  // Asked to hold back
+  uint16_t          bad_frames    = 0;
+  uint16_t          dropped_bytes = 0;
+
+  // Decoder state
+  uint8_t  rx_state;
+  uint8_t  rx_addr;
+  uint8_t  rx_ctrl;
+  uint8_t  rx_fcs;
+  uint16_t rx_len;
+  uint16_t rx_pos;
+  uint8_t  rx_frame[TINY_GSM_MUX_FRAME];
+};
+
+/*
+ * Channel functions
+ */
+inline size_t TinyGsmMuxChannel::write(const uint8_t* buf, size_t size) {
+  if (!mux->isOpen(dlci)) { return 0; }
+  size_t sent = 0;
+  while (sent < size) {
+    size_t n = TinyGsmMin(static_cast<size_t>(TINY_GSM_MUX_FRAME - tx_len),
+                          size - sent);
+    memcpy(tx + tx_len, buf + sent, n);
+    tx_len += n;
+    sent += n;
+    if (tx_len == TINY_GSM_MUX_FRAME) { sendPending(); }
+  }
+  return sent;
+}
+
+inline int TinyGsmMuxChannel::available() {
+  sendPending();
+  mux->poll();
+  return rx.size();
+}
+
+inline int TinyGsmMuxChannel::read() {
+  sendPending();
+  mux->poll();
+  uint8_t c;
+  if (!rx.get(&c)) { return -1; }
+  mux->updateFlow(dlci);
+  return c;
+}
+
+inline int TinyGsmMuxChannel::peek() {
+  sendPending();
+  mux->poll();
+  return rx.peek();
+}
+
+inline void TinyGsmMuxChannel::flush() {
+  sendPending();
+  mux->stream.flush();
+}
+
+inline void TinyGsmMuxChannel::sendPending() {
+  if (!tx_len) { return; }
+  // Waits up to the channel's time-out for the modem to take data again
+  uint32_t startMillis = millis();
+  while (mux->isHeld(dlci) && millis() - startMillis < _timeout) {
+    TINY_GSM_YIELD();
+    mux->poll();
+  }
+  mux->sendFrame(dlci, TinyGsmMux::FRAME_UIH, tx, tx_len, true);
+  tx_len = 0;
+}
+
+#endif  // SRC_TINYGSMMUX_H_
@@ -57,8 +57,7 @@ class TinyGsmNTP {
   byte NTPServerSyncImpl(String server = "pool.ntp.org", byte TimeZone = 3) {
     // Set GPRS bearer profile to associate with NTP sync
     // this may fail, it's not supported by all modules
-    thisModem().sendAT(GF("+CNTPCID=1"));
-    thisModem().waitResponse(10000L);
+    thisModem().sendATCached(SETTING_CNTPCID, 1, 10000L, GF("+CNTPCID=1"));
 
     // Set NTP server and timezone
     thisModem().sendAT(GF("+CNTP=\""), server, "\",", String(TimeZone));
@@ -0,0 +1,81 @@
+/**
+ * @file       TinyGsmPPP.tpp
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Nov 2016
+ */
+
+#ifndef SRC_TINYGSMPPP_H_
+#define SRC_TINYGSMPPP_H_
+
+#include "TinyGsmCommon.h"
+
+#define TINY_GSM_MODEM_HAS_PPP
+
+// PPP mode: the modem's packet data connection is dialed with ATD*99***1#
+// and the serial port then carries the PPP link for an IP stack running on
+// the MCU, e.g. by passing the received bytes to lwIP's pppos_input() or
+// through a TinyGsmHdlc framer.  Like the transparent mode, no other modem
+// function may be used until pppDisconnect().
+template <class modemType>
+class TinyGsmPPP {
+ public:
+  /*
+   * PPP functions
+   */
+  bool pppConnect(const char* apn, uint32_t timeout_ms = 30000L) {
+    return thisModem().pppConnectImpl(apn, timeout_ms);
+  }
+  // Hangs up, after which AT commands can be used again
+  bool pppDisconnect() {
+    return thisModem().pppDisconnectImpl();
+  }
+  // Whether the serial port is currently carrying the PPP link.  Stays set
+  // if the modem drops the link by itself, as its NO CARRIER arrives in band.
+  bool isPppConnected() {
+    return pppActive;
+  }
+
+  /*
+   * CRTP Helper
+   */
+ protected:
+  inline const modemType& thisModem() const {
+    return static_cast<const modemType&>(*this);
+  }
+  inline modemType& thisModem() {
+    return static_cast<modemType&>(*this);
+  }
+
+  /*
+   * PPP functions
+   */
+ protected:
+  bool pppConnectImpl(const char* apn, uint32_t timeout_ms) {
+    thisModem().sendAT(GF("+CGDCONT=1,\"IP\",\""), apn, '"');
+    if (thisModem().waitResponse() != 1) { return false; }
+    thisModem().sendAT(GF("D*99***1#"));
+    if (thisModem().waitResponse(timeout_ms, GF("CONNECT"), GF("ERROR"),
+                                 GF("NO CARRIER")) != 1) {
+      return false;
+    }
+    thisModem().streamSkipUntil('\n');  // The link starts after this line
+    pppActive = true;
+    return true;
+  }
+
+  bool pppDisconnectImpl() {
+    if (!pppActive) { return true; }
+    // If the link is already gone the modem is back in command mode and
+    // just takes the "+++" as a bad command
+    if (!thisModem().escapeDataMode()) { return false; }
+    pppActive = false;
+    thisModem().sendAT(GF("H"));
+    return thisModem().waitResponse(10000L) == 1;
+  }
+
+  bool pppActive = false;
+};
+
+#endif  // SRC_TINYGSMPPP_H_
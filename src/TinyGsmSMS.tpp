@@ -113,11 +113,9 @@ class TinyGsmSMS {
 
   String sendUSSDImpl(const String& code) {
     // Set preferred message format to text mode
-    thisModem().sendAT(GF("+CMGF=1"));
-    thisModem().waitResponse();
+    thisModem().sendATCached(SETTING_CMGF, 1, 1000L, GF("+CMGF=1"));
     // Set 8-bit hexadecimal alphabet (3GPP TS 23.038)
-    thisModem().sendAT(GF("+CSCS=\"HEX\""));
-    thisModem().waitResponse();
+    thisModem().sendATCached(SETTING_CSCS, 1, 1000L, GF("+CSCS=\"HEX\""));
     // Send the message
     thisModem().sendAT(GF("+CUSD=1,\""), code, GF("\""));
     if (thisModem().waitResponse() != 1) { return ""; }
@@ -138,11 +136,9 @@ class TinyGsmSMS {
 
   bool sendSMSImpl(const String& number, const String& text) {
     // Set preferred message format to text mode
-    thisModem().sendAT(GF("+CMGF=1"));
-    thisModem().waitResponse();
+    thisModem().sendATCached(SETTING_CMGF, 1, 1000L, GF("+CMGF=1"));
     // Set GSM 7 bit default alphabet (3GPP TS 23.038)
-    thisModem().sendAT(GF("+CSCS=\"GSM\""));
-    thisModem().waitResponse();
+    thisModem().sendATCached(SETTING_CSCS, 0, 1000L, GF("+CSCS=\"GSM\""));
     thisModem().sendAT(GF("+CMGS=\""), number, GF("\""));
     if (thisModem().waitResponse(GF(">")) != 1) { return false; }
     thisModem().stream.print(text);  // Actually send the message
@@ -183,12 +179,10 @@ class TinyGsmSMS {
   };
 
   bool sendSMS_UTF8_begin(const char* const number) {
-    thisModem().sendAT(GF("+CMGF=1"));
-    thisModem().waitResponse();
-    thisModem().sendAT(GF("+CSCS=\"HEX\""));
-    thisModem().waitResponse();
-    thisModem().sendAT(GF("+CSMP=17,167,0,8"));
-    thisModem().waitResponse();
+    thisModem().sendATCached(SETTING_CMGF, 1, 1000L, GF("+CMGF=1"));
+    thisModem().sendATCached(SETTING_CSCS, 1, 1000L, GF("+CSCS=\"HEX\""));
+    thisModem().sendATCached(SETTING_CSMP, 8, 1000L,
+                             GF("+CSMP=17,167,0,8"));
 
     thisModem().sendAT(GF("+CMGS=\""), number, GF("\""));
     return thisModem().waitResponse(GF(">")) == 1;
@@ -19,6 +19,30 @@
 #define TINY_GSM_RX_BUFFER 64
 #endif
 
+// The most data a single modem read command may ask for
+#if !defined(TINY_GSM_MAX_READ)
+#define TINY_GSM_MAX_READ 1460
+#endif
+
+// The most data a single modem send command may carry; longer writes are
+// split up.  Each modem sets its own.
+#if !defined(TINY_GSM_MAX_SEND)
+#define TINY_GSM_MAX_SEND 1460
+#endif
+
+// Size of each client's TX buffer, which gathers up small writes (such as
+// those from print()) so they go out in one send command.  0 disables it and
+// every write is sent straight away.
+#if !defined(TINY_GSM_TX_BUFFER)
+#define TINY_GSM_TX_BUFFER 0
+#endif
+
+// How long buffered TX data may sit without further writes before maintain()
+// sends it
+#if !defined(TINY_GSM_TX_FLUSH_MS)
+#define TINY_GSM_TX_FLUSH_MS 50
+#endif
+
 // Because of the ordering of resolution of overrides in templates, these need
 // to be written out every time.  This macro is to shorten that.
 #define TINY_GSM_CLIENT_CONNECT_OVERRIDES                             \
@@ -41,6 +65,14 @@
 // // of the buffer
 // #define TINY_GSM_BUFFER_READ_AND_CHECK_SIZE
 
+// One piece of data for a scatter-gather write.  Pieces with flash set are
+// read from flash (PROGMEM on AVR), e.g. {GF("HELLO"), 5, true}.
+struct TinyGsmSegment {
+  const void* data;
+  size_t      len;
+  bool        flash;
+};
+
 template <class modemType, uint8_t muxCount>
 class TinyGsmTCP {
  public:
@@ -48,6 +80,15 @@ class TinyGsmTCP {
    * Basic functions
    */
   void maintain() {
+#if TINY_GSM_TX_BUFFER > 0
+    for (int mux = 0; mux < muxCount; mux++) {
+      GsmClient* sock = thisModem().sockets[mux];
+      if (sock && sock->tx_len &&
+          millis() - sock->tx_last >= TINY_GSM_TX_FLUSH_MS) {
+        sock->flushTx();
+      }
+    }
+#endif
     return thisModem().maintainImpl();
   }
 
@@ -69,9 +110,11 @@ class TinyGsmTCP {
   class GsmClient : public Client {
     // Make all classes created from the modem template friends
     friend class TinyGsmTCP<modemType, muxCount>;
-    typedef TinyGsmFifo<uint8_t, TINY_GSM_RX_BUFFER> RxFifo;
+    typedef TinyGsmFifoView<uint8_t> RxFifo;
 
    public:
+    GsmClient() {}
+
     // bool init(modemType* modem, uint8_t);
     // int connect(const char* host, uint16_t port, int timeout_s);
 
@@ -109,8 +152,21 @@ class TinyGsmTCP {
     // Writes data out on the client using the modem send functionality
     size_t write(const uint8_t* buf, size_t size) override {
       TINY_GSM_YIELD();
+#if TINY_GSM_TX_BUFFER > 0
+      // Hold on to small writes until the buffer fills, the client is
+      // flushed or read from, or nothing more is written for a while
+      if (size < TINY_GSM_TX_BUFFER && sock_connected) {
+        if (tx_len + size > TINY_GSM_TX_BUFFER) { flushTx(); }
+        memcpy(tx_buffer + tx_len, buf, size);
+        tx_len += size;
+        tx_last = millis();
+        if (tx_len == TINY_GSM_TX_BUFFER) { flushTx(); }
+        return size;
+      }
+      flushTx();
+#endif
       at->maintain();
-      return at->modemSend(buf, size, mux);
+      return modemSendAll(buf, size);
     }
 
     size_t write(uint8_t c) override {
@@ -122,8 +178,67 @@ class TinyGsmTCP {
       return write((const uint8_t*)str, strlen(str));
     }
 
+    // Writes the segments out one after the other as a single piece of data,
+    // using as few send commands as a buffer of the same total length and
+    // without first copying them together
+    size_t write(const TinyGsmSegment* segments, uint8_t count) {
+      TINY_GSM_YIELD();
+      flushTx();
+      size_t size = 0;
+      for (uint8_t i = 0; i < count; i++) { size += segments[i].len; }
+      at->maintain();
+      at->txSegments     = segments;
+      at->txSegmentCount = count;
+      at->txSegmentPos   = 0;
+      size_t sent        = modemSendAll(NULL, size);
+      at->txSegments     = NULL;
+      return sent;
+    }
+
+    // Sends len bytes read from src, e.g. a file on an SD card.  Each send
+    // announces no more than src says it has, up to TINY_GSM_MAX_SEND, and
+    // is then streamed from src straight into the modem's prompt.  A send
+    // can't be taken back once announced, so if src delivers less than it
+    // said, the rest is padded out and the connection is closed, and the
+    // peer never takes the padding for data.  Stops early if src has nothing more
+    // to give within the client's time-out, or if the modem takes less than
+    // it was given, which src has then been read past.  Returns the number
+    // of bytes from src the modem took.
+    size_t writeFrom(Stream& src, size_t len) {
+      TINY_GSM_YIELD();
+      flushTx();
+      at->maintain();
+      size_t sent   = 0;
+      bool   padded = false;
+      at->txStream  = &src;
+      while (sent < len) {
+        uint32_t startMillis = millis();
+        int      avail;
+        while ((avail = src.available()) <= 0 &&
+               millis() - startMillis < _timeout) {
+          TINY_GSM_YIELD();
+        }
+        if (avail <= 0) { break; }
+        size_t chunk = TinyGsmMin(len - sent, static_cast<size_t>(avail));
+        chunk        = TinyGsmMin(chunk,
+                                  static_cast<size_t>(TINY_GSM_MAX_SEND));
+        at->txStreamMissed = 0;
+        int n              = at->modemSend(NULL, chunk, mux);
+        if (n <= 0) { break; }
+        size_t accepted = TinyGsmMin(static_cast<size_t>(n), chunk);
+        padded          = at->txStreamMissed > 0;
+        // Only the bytes ahead of the padding came from src
+        sent += TinyGsmMin(accepted, chunk - at->txStreamMissed);
+        if (padded || accepted < chunk) { break; }
+      }
+      at->txStream = NULL;
+      if (padded) { stop(); }
+      return sent;
+    }
+
     int available() override {
       TINY_GSM_YIELD();
+      flushTx();
 #if defined TINY_GSM_NO_MODEM_BUFFER
       // Returns the number of characters available in the TinyGSM fifo
       if (!rx.size() && sock_connected) { at->maintain(); }
@@ -157,6 +272,7 @@ class TinyGsmTCP {
 
     int read(uint8_t* buf, size_t size) override {
       TINY_GSM_YIELD();
+      flushTx();
       size_t cnt = 0;
 
 #if defined TINY_GSM_NO_MODEM_BUFFER
@@ -170,8 +286,18 @@ class TinyGsmTCP {
           buf += chunk;
           cnt += chunk;
           continue;
-        } /* TODO: Read directly into user buffer? */
-        if (!rx.size() && sock_connected) { at->maintain(); }
+        }
+        if (!rx.size() && sock_connected) {
+          // Let any data URC write straight into the caller's buffer
+          rx_direct     = buf;
+          rx_direct_len = size - cnt;
+          at->maintain();
+          chunk         = rx_direct - buf;
+          rx_direct     = NULL;
+          rx_direct_len = 0;
+          buf += chunk;
+          cnt += chunk;
+        }
       }
       return cnt;
 
@@ -186,12 +312,13 @@ class TinyGsmTCP {
           buf += chunk;
           cnt += chunk;
           continue;
-        } /* TODO: Read directly into user buffer? */
+        }
         at->maintain();
         if (sock_available > 0) {
-          int n = at->modemRead(TinyGsmMin((uint16_t)rx.free(), sock_available),
-                                mux);
-          if (n == 0) break;
+          int n = modemReadDirect(buf, size - cnt);
+          if (n < 0) break;
+          buf += n;
+          cnt += n;
         } else {
           break;
         }
@@ -218,12 +345,12 @@ class TinyGsmTCP {
           got_data   = true;
           prev_check = millis();
         }
-        // TODO(vshymanskyy): Read directly into user buffer?
         at->maintain();
         if (sock_available > 0) {
-          int n = at->modemRead(TinyGsmMin((uint16_t)rx.free(), sock_available),
-                                mux);
-          if (n == 0) break;
+          int n = modemReadDirect(buf, size - cnt);
+          if (n < 0) break;
+          buf += n;
+          cnt += n;
         } else {
           break;
         }
@@ -242,10 +369,11 @@ class TinyGsmTCP {
     }
 
 	int peek() override {
-		return (uint8_t)rx.peek();
+		return rx.peek();
 	}
 
     void flush() override {
+      flushTx();
       at->stream.flush();
     }
 
@@ -278,7 +406,87 @@ class TinyGsmTCP {
 
     String remoteIP() TINY_GSM_ATTR_NOT_IMPLEMENTED;
 
+    // Number of bytes sent on this socket that the remote end hasn't yet
+    // acknowledged, or -1 if the modem can't tell
+    int16_t pendingTxBytes() {
+      return at->modemGetPendingTx(mux);
+    }
+
+    // Number of bytes that can be written before the modem's send buffer for
+    // this socket is full, or -1 if the modem can't tell
+    int16_t txFreeSpace() {
+      return at->modemGetTxFree(mux);
+    }
+
    protected:
+    // Sends anything waiting in the TX buffer.  Whatever the modem doesn't
+    // accept is dropped, as the writes have already been reported as done.
+    inline void flushTx() {
+#if TINY_GSM_TX_BUFFER > 0
+      if (!tx_len) { return; }
+      size_t len = tx_len;
+      tx_len     = 0;
+      if (sock_connected) { modemSendAll(tx_buffer, len); }
+#endif
+    }
+
+    // Sends data in pieces of at most TINY_GSM_MAX_SEND, until it has all
+    // been sent or the modem stops accepting it.  Returns how much was sent.
+    // buf is NULL when the data comes from the modem's TX source instead.
+    inline size_t modemSendAll(const uint8_t* buf, size_t size) {
+      size_t sent = 0;
+      while (sent < size) {
+        size_t len = TinyGsmMin(size - sent,
+                                static_cast<size_t>(TINY_GSM_MAX_SEND));
+        int    n   = at->modemSend(buf ? buf + sent : NULL, len, mux);
+        if (n <= 0) { break; }
+        size_t accepted = TinyGsmMin(static_cast<size_t>(n), len);
+        // The next send has to start with whatever the modem didn't take
+        if (!buf && accepted < len) { at->modemRewindPayload(len - accepted); }
+        sent += accepted;
+      }
+      return sent;
+    }
+
+    // Room for data read from the modem: what's left of the reader's buffer
+    // during a direct read, plus the free space in the fifo
+    inline size_t rxFree() {
+      return rx_direct_len + rx.free();
+    }
+
+    // Queues data read from the modem for this socket.  During a direct read
+    // it goes straight into the reader's buffer, and only what doesn't fit
+    // there goes into the fifo.
+    inline void rxPut(uint8_t c) {
+      if (rx_direct_len) {
+        *rx_direct++ = c;
+        rx_direct_len--;
+      } else {
+        rx.put(c);
+      }
+    }
+
+#if defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE || \
+    defined TINY_GSM_BUFFER_READ_NO_CHECK
+    // Reads data from the modem's buffer straight into buf, skipping the
+    // fifo.  Unless the caller wants more than the fifo holds, the fifo is
+    // topped up with whatever else is available.  Only called when the fifo
+    // is empty.  Returns the number of characters put into buf, or -1 if the
+    // modem read failed.
+    inline int modemReadDirect(uint8_t* buf, size_t size) {
+      size_t want = TinyGsmMax(size, static_cast<size_t>(rx.free()));
+      want        = TinyGsmMin(want, static_cast<size_t>(sock_available));
+      want        = TinyGsmMin(want, static_cast<size_t>(TINY_GSM_MAX_READ));
+      rx_direct     = buf;
+      rx_direct_len = size;
+      size_t n      = at->modemRead(want, mux);
+      size_t direct = rx_direct - buf;
+      rx_direct     = NULL;
+      rx_direct_len = 0;
+      return n ? static_cast<int>(direct) : -1;
+    }
+#endif
+
     // Read and dump anything remaining in the modem's internal buffer.
     // Using this in the client stop() function.
     // The socket will appear open in response to connected() even after it
@@ -286,6 +494,7 @@ class TinyGsmTCP {
     // Doing it this way allows the external mcu to find and get all of the
     // data that it wants from the socket even if it was closed externally.
     inline void dumpModemBuffer(uint32_t maxWaitMs) {
+      flushTx();
 #if defined TINY_GSM_BUFFER_READ_AND_CHECK_SIZE || \
     defined TINY_GSM_BUFFER_READ_NO_CHECK
       TINY_GSM_YIELD();
@@ -312,7 +521,36 @@ class TinyGsmTCP {
     uint32_t   prev_check;
     bool       sock_connected;
     bool       got_data;
-    RxFifo     rx;
+    RxFifo     rx;  // Over the storage of the TinyGsmClientRx around this
+    uint8_t*   rx_direct     = NULL;  // The reader's buffer, during a read
+    size_t     rx_direct_len = 0;     // Space left in rx_direct
+#if TINY_GSM_TX_BUFFER > 0
+    uint8_t  tx_buffer[TINY_GSM_TX_BUFFER];
+    size_t   tx_len  = 0;
+    uint32_t tx_last = 0;  // When tx_buffer was last written to
+#endif
+
+    // The room for received data, which only the TinyGsmClientRx around a
+    // client provides.  Without it rx would hold nothing, so a modem's own
+    // client class can't be used by itself.
+    virtual size_t rxCapacity() const = 0;
+
+    // Only TinyGsmClientRx moves a client, and then also moves rx and the
+    // modem's pointer to the client over to the new one
+    GsmClient(GsmClient&&) = default;
+
+    // Points the modem at the client that took over from, if it was the one
+    // registered for this socket
+    template <class T>
+    void takeSocket(const GsmClient* from, T* to) {
+      if (at && at->sockets[mux] == from) { at->sockets[mux] = to; }
+    }
+
+   public:
+    // The modem keeps a pointer to each client and rx points into it, so a
+    // copy would be left out of both
+    GsmClient(const GsmClient&)            = delete;
+    GsmClient& operator=(const GsmClient&) = delete;
   };
 
   /*
@@ -343,6 +581,14 @@ class TinyGsmTCP {
 #endif
   }
 
+  // Defaults for modems that can't report the state of their send buffers
+  int16_t modemGetPendingTx(uint8_t) {
+    return -1;
+  }
+  int16_t modemGetTxFree(uint8_t) {
+    return -1;
+  }
+
   // Yields up to a time-out period and then reads a character from the stream
   // into the mux FIFO
   // TODO(SRGDamia1):  Do we need to wait two _timeout periods for no
@@ -357,8 +603,203 @@ class TinyGsmTCP {
       TINY_GSM_YIELD();
     }
     char c = thisModem().stream.read();
-    thisModem().sockets[mux]->rx.put(c);
+    thisModem().sockets[mux]->rxPut(c);
+  }
+
+  // Moves len characters of socket data from the stream into the mux FIFO in
+  // chunks, rather than one at a time, giving up if nothing arrives for the
+  // socket's time-out period.  The chunks are read straight into the FIFO's
+  // free space, or into the reader's buffer during a direct read.  Characters
+  // that don't fit in the FIFO are dropped.  Returns the number of characters
+  // kept, in the reader's buffer and the FIFO together.
+  inline size_t moveBytesFromStreamToFifo(uint8_t mux, size_t len) {
+    GsmClient* sock = thisModem().sockets[mux];
+    if (!sock) return 0;
+    size_t   moved       = 0;
+    size_t   kept        = 0;
+    uint32_t startMillis = millis();
+    while (moved < len) {
+      int avail = thisModem().stream.available();
+      if (avail <= 0) {
+        if (millis() - startMillis >= sock->_timeout) { break; }
+        TINY_GSM_YIELD();
+        continue;
+      }
+      size_t n = TinyGsmMin(len - moved, static_cast<size_t>(avail));
+      if (sock->rx_direct_len) {
+        n = thisModem().stream.readBytes(
+            sock->rx_direct, TinyGsmMin(n, sock->rx_direct_len));
+        sock->rx_direct += n;
+        sock->rx_direct_len -= n;
+        kept += n;
+      } else {
+        size_t   span;
+        uint8_t* dst = sock->rx.writeSpan(span);
+        if (span) {
+          n = thisModem().stream.readBytes(dst, TinyGsmMin(n, span));
+          sock->rx.commitWrite(n);
+          kept += n;
+        } else {
+          n = thisModem().stream.read() >= 0;  // No room, drop it
+        }
+      }
+      moved += n;
+      startMillis = millis();
+    }
+    return kept;
+  }
+
+  // Writes len bytes of data for a send command once the modem has prompted
+  // for it.  They come from buff, or from the segments of a scatter-gather
+  // write or the stream of a writeFrom in progress.  With hex set, each byte
+  // goes out as two hex digits.
+  void modemWritePayload(const void* buff, size_t len, bool hex = false) {
+    if (txStream) {
+      // The modem needs all len bytes, so if the stream comes up short the
+      // rest is padded out; writeFrom then closes the connection
+      uint8_t buf[32];
+      while (len) {
+        size_t n = TinyGsmMin(len, sizeof(buf));
+        size_t k = txStream->readBytes(buf, n);
+        memset(buf + k, 0, n - k);
+        txStreamMissed += n - k;
+        modemWritePiece(buf, n, false, hex);
+        len -= n;
+      }
+      return;
+    }
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(buff);
+    while (len) {
+      size_t n     = len;
+      bool   flash = false;
+      if (txSegments) {
+        if (!txSegmentCount) { break; }
+        const TinyGsmSegment& seg = *txSegments;
+        if (txSegmentPos >= seg.len) {
+          txSegments++;
+          txSegmentCount--;
+          txSegmentPos = 0;
+          continue;
+        }
+        p     = static_cast<const uint8_t*>(seg.data) + txSegmentPos;
+        n     = TinyGsmMin(len, seg.len - txSegmentPos);
+        flash = seg.flash;
+        txSegmentPos += n;
+      }
+      modemWritePiece(p, n, flash, hex);
+      p += n;
+      len -= n;
+    }
+  }
+
+  // Moves the segments of a scatter-gather write back by n bytes, after the
+  // modem took less than the last modemWritePayload gave it
+  void modemRewindPayload(size_t n) {
+    if (!txSegments) { return; }
+    while (n) {
+      if (!txSegmentPos) {
+        txSegments--;
+        txSegmentCount++;
+        txSegmentPos = txSegments->len;
+        continue;
+      }
+      size_t k = TinyGsmMin(n, txSegmentPos);
+      txSegmentPos -= k;
+      n -= k;
+    }
   }
+
+  void modemWritePiece(const uint8_t* p, size_t n, bool flash, bool hex) {
+    if (!flash && !hex) {
+      thisModem().stream.write(p, n);
+      return;
+    }
+    // Flash and hex data go through a small staging buffer
+    static const char digits[] = "0123456789ABCDEF";
+    uint8_t           buf[32];
+    while (n) {
+      size_t k = TinyGsmMin(n, hex ? sizeof(buf) / 2 : sizeof(buf));
+      if (flash) {
+        TINY_GSM_MEMCPY_P(buf, p, k);
+      } else {
+        memcpy(buf, p, k);
+      }
+      p += k;
+      n -= k;
+      if (hex) {
+        for (size_t i = k; i-- > 0;) {
+          uint8_t b      = buf[i];
+          buf[2 * i]     = digits[b >> 4];
+          buf[2 * i + 1] = digits[b & 0x0F];
+        }
+        k *= 2;
+      }
+      thisModem().stream.write(buf, k);
+    }
+  }
+
+  // The segments of a scatter-gather write in progress
+  const TinyGsmSegment* txSegments     = NULL;
+  uint8_t               txSegmentCount = 0;
+  size_t                txSegmentPos   = 0;  // Position in txSegments[0]
+
+  // The source of a writeFrom in progress
+  Stream* txStream       = NULL;
+  size_t  txStreamMissed = 0;  // Padding sent when it came up short
+};
+
+/**
+ * A modem's client with the storage for its RX fifo.  The modems' own client
+ * classes have none and so can't be used by themselves; TinyGsmClient and
+ * TinyGsmClientSecure are this around them with the default
+ * TINY_GSM_RX_BUFFER.  Wrapping one of those
+ * again gives it RX bytes instead, so that one busy socket can get a large
+ * buffer while the others stay small, e.g.
+ *   TinyGsmClientRx<TinyGsmClient, 1460> download(modem, 0);
+ *   TinyGsmClient                        mqtt(modem, 1);
+ */
+template <class ClientType, unsigned RX = TINY_GSM_RX_BUFFER>
+class TinyGsmClientRx : public ClientType {
+ public:
+  TinyGsmClientRx() {
+    this->rx.attach(rx_storage, RX);
+  }
+
+  template <class modemType>
+  explicit TinyGsmClientRx(modemType& modem, uint8_t mux = 0)
+      : ClientType(modem, mux) {
+    this->rx.attach(rx_storage, RX);
+  }
+
+  // Takes over other's socket and whatever it has received, as needed for
+  // e.g. TinyGsmClient client = TinyGsmClient(modem);
+  TinyGsmClientRx(TinyGsmClientRx&& other)
+      : ClientType(static_cast<ClientType&&>(other)) {
+    this->rx.attach(rx_storage, RX);
+    uint8_t c;
+    while (other.rx.get(&c)) { this->rx.put(c); }
+    this->takeSocket(&other, this);
+  }
+
+ protected:
+  size_t rxCapacity() const override {
+    return RX;
+  }
+
+ private:
+  uint8_t rx_storage[RX];
+};
+
+// Re-wrapping a client replaces its buffer rather than adding another one
+template <class ClientType, unsigned RX0, unsigned RX>
+class TinyGsmClientRx<TinyGsmClientRx<ClientType, RX0>, RX>
+    : public TinyGsmClientRx<ClientType, RX> {
+ public:
+  TinyGsmClientRx() {}
+
+  template <class modemType>
+  explicit TinyGsmClientRx(modemType& modem, uint8_t mux = 0)
+      : TinyGsmClientRx<ClientType, RX>(modem, mux) {}
 };
 
 #endif  // SRC_TINYGSMTCP_H_
@@ -0,0 +1,304 @@
+/**
+ * @file       TinyGsmTransparent.tpp
+ * @author     Volodymyr Shymanskyy
+ * @license    LGPL-3.0
+ * @copyright  Copyright (c) 2016 Volodymyr Shymanskyy
+ * @date       Nov 2016
+ */
+
+#ifndef SRC_TINYGSMTRANSPARENT_H_
+#define SRC_TINYGSMTRANSPARENT_H_
+
+#include "TinyGsmCommon.h"
+
+#define TINY_GSM_MODEM_HAS_TRANSPARENT
+
+// How long the start of what may be a close message is held back from the
+// reader waiting for the rest of it.  The modem sends the whole message in
+// one go, so anything that stops short for this long was just data.
+#if !defined(TINY_GSM_TRANSPARENT_HOLD_MS)
+#define TINY_GSM_TRANSPARENT_HOLD_MS 50
+#endif
+
+// The messages with which a modem in data mode reports that the peer closed
+// the connection, after which it is back in command mode
+static const char GSM_NO_CARRIER[] TINY_GSM_PROGMEM = "\r\nNO CARRIER\r\n";
+static const char GSM_CLOSED[] TINY_GSM_PROGMEM     = "\r\nCLOSED\r\n";
+
+// Transparent (data) mode: a single connection whose raw data flows straight
+// over the serial port, without any AT command wrapped around each chunk.
+//
+// While the modem is in data mode it doesn't understand AT commands, so no
+// other modem functions, including maintain(), may be used until
+// exitDataMode() has switched it back to command mode.  The connection stays
+// open and resumeDataMode() switches back to it.
+//
+// The modem reports the peer closing the connection in band, so the data is
+// watched for those messages.  Data that happens to contain one exactly, line
+// breaks included, is taken as the connection closing.
+template <class modemType>
+class TinyGsmTransparent {
+ public:
+  /*
+   * Transparent mode functions
+   */
+  // Whether the serial port is currently carrying the connection's data
+  bool isDataMode() {
+    return dataMode;
+  }
+  // Switches to command mode, leaving the connection open.  Anything the
+  // modem sends while switching is lost.
+  bool exitDataMode() {
+    return thisModem().exitDataModeImpl();
+  }
+  // Switches back to the data of the open connection
+  bool resumeDataMode() {
+    return thisModem().resumeDataModeImpl();
+  }
+
+  /*
+   * CRTP Helper
+   */
+ protected:
+  inline const modemType& thisModem() const {
+    return static_cast<const modemType&>(*this);
+  }
+  inline modemType& thisModem() {
+    return static_cast<modemType&>(*this);
+  }
+
+  /*
+   * Inner Transparent Client
+   */
+ public:
+  class GsmClientTransparent : public Client {
+   public:
+    GsmClientTransparent() {}
+
+    explicit GsmClientTransparent(modemType& modem, uint8_t mux = 0) {
+      init(&modem, mux);
+    }
+
+    bool init(modemType* modem, uint8_t mux = 0) {
+      this->at       = modem;
+      this->mux      = mux;
+      sock_connected = false;
+      peer_closed    = false;
+      holdLen        = 0;
+      holdReady      = 0;
+      return true;
+    }
+
+   public:
+    int connect(const char* host, uint16_t port, int timeout_s) {
+      stop();
+      TINY_GSM_YIELD();
+      holdLen        = 0;
+      holdReady      = 0;
+      sock_connected = at->transparentConnectImpl(host, port, mux, timeout_s);
+      at->dataMode   = sock_connected;
+      at->dataMux    = mux;
+      return sock_connected;
+    }
+    int connect(IPAddress ip, uint16_t port, int timeout_s) {
+      return connect(modemType::GsmClient::TinyGsmStringFromIp(ip).c_str(),
+                     port, timeout_s);
+    }
+    int connect(const char* host, uint16_t port) override {
+      return connect(host, port, 75);
+    }
+    int connect(IPAddress ip, uint16_t port) override {
+      return connect(ip, port, 75);
+    }
+
+    // Also needed after the peer has closed the connection, to free it on
+    // the modem's side
+    void stop(uint32_t maxWaitMs) {
+      if (!sock_connected && !peer_closed) { return; }
+      if (at->dataMode) { at->exitDataMode(); }
+      at->transparentStopImpl(mux, maxWaitMs);
+      sock_connected = false;
+      peer_closed    = false;
+      holdLen        = 0;
+      holdReady      = 0;
+    }
+    void stop() override {
+      stop(15000L);
+    }
+
+    size_t write(const uint8_t* buf, size_t size) override {
+      if (!at->dataMode) { return 0; }
+      return at->stream.write(buf, size);
+    }
+
+    size_t write(uint8_t c) override {
+      return write(&c, 1);
+    }
+
+    int available() override {
+      TINY_GSM_YIELD();
+      pump();
+      if (!holdReady) { return 0; }
+      // Whatever follows a partial close message isn't known to be data yet
+      if (holdLen > holdReady || !at->dataMode) { return holdReady; }
+      return holdReady + at->stream.available();
+    }
+
+    // Waits up to the client's time-out for size characters, or until the
+    // peer closes the connection
+    int read(uint8_t* buf, size_t size) override {
+      TINY_GSM_YIELD();
+      if (!at->dataMode && !holdLen) { return -1; }
+      size_t   cnt         = 0;
+      uint32_t startMillis = millis();
+      while (cnt < size && millis() - startMillis < _timeout) {
+        size_t n = readSome(buf + cnt, size - cnt);
+        if (!n) {
+          if (!at->dataMode && !holdLen) { break; }
+          TINY_GSM_YIELD();
+        }
+        cnt += n;
+      }
+      return cnt;
+    }
+
+    int read() override {
+      uint8_t c;
+      if (read(&c, 1) == 1) { return c; }
+      return -1;
+    }
+
+    int peek() override {
+      pump();
+      return holdReady ? hold[0] : -1;
+    }
+
+    void flush() override {
+      at->stream.flush();
+    }
+
+    uint8_t connected() override {
+      if (available()) { return true; }
+      return sock_connected;
+    }
+    operator bool() override {
+      return connected();
+    }
+
+   protected:
+    // Reads whatever data is there without waiting, at most size characters.
+    // Runs of data without a CR can't hold a close message, so they go
+    // straight into buf; the rest goes through the hold buffer, compacting
+    // buf as it goes.
+    size_t readSome(uint8_t* buf, size_t size) {
+      expireHold();
+      size_t cnt = takeHeld(buf, size);
+      if (cnt == size || holdReady || !at->dataMode) { return cnt; }
+      int avail = at->stream.available();
+      if (avail <= 0) { return cnt; }
+      size_t   n   = at->stream.readBytes(
+          buf + cnt, TinyGsmMin(size - cnt, static_cast<size_t>(avail)));
+      uint8_t* in  = buf + cnt;
+      uint8_t* out = in;
+      for (size_t i = 0; i < n && at->dataMode; i++) {
+        if (!holdLen && in[i] != '\r') {
+          *out++ = in[i];
+          continue;
+        }
+        feed(in[i]);
+        // Never more than has been read, so it can't overtake the input
+        out += takeHeld(out, in + i + 1 - out);
+      }
+      return out - buf;
+    }
+
+    // Moves stream data into the hold buffer until some is known to be data
+    void pump() {
+      expireHold();
+      while (!holdReady && at->dataMode && at->stream.available() > 0) {
+        feed(at->stream.read());
+      }
+    }
+
+    void feed(uint8_t c) {
+      hold[holdLen++] = c;
+      holdSince       = millis();
+      // Release everything that can no longer be the start of a message
+      bool complete = false;
+      while (holdReady < holdLen &&
+             !closeStart(hold + holdReady, holdLen - holdReady, complete)) {
+        holdReady++;
+      }
+      if (complete) {
+        holdLen        = holdReady;
+        sock_connected = false;
+        peer_closed    = true;
+        at->dataMode   = false;
+        DBG("### Closed by peer");
+      }
+    }
+
+    void expireHold() {
+      if (holdLen > holdReady &&
+          millis() - holdSince >= TINY_GSM_TRANSPARENT_HOLD_MS) {
+        holdReady = holdLen;
+      }
+    }
+
+    size_t takeHeld(uint8_t* buf, size_t size) {
+      size_t n = TinyGsmMin(size, static_cast<size_t>(holdReady));
+      if (!n) { return 0; }
+      memcpy(buf, hold, n);
+      memmove(hold, hold + n, holdLen - n);
+      holdLen -= n;
+      holdReady -= n;
+      return n;
+    }
+
+    // Whether the n characters at p start one of the close messages, setting
+    // complete if they are all of it
+    static bool closeStart(const uint8_t* p, uint8_t n, bool& complete) {
+      static const char* const messages[] = {GSM_NO_CARRIER, GSM_CLOSED};
+      bool                     found      = false;
+      for (uint8_t m = 0; m < 2; m++) {
+        uint8_t i = 0;
+        while (i < n && TINY_GSM_PGM_CHAR(messages[m] + i) &&
+               TINY_GSM_PGM_CHAR(messages[m] + i) == static_cast<char>(p[i])) {
+          i++;
+        }
+        if (i < n) { continue; }
+        found = true;
+        if (!TINY_GSM_PGM_CHAR(messages[m] + n)) { complete = true; }
+      }
+      return found;
+    }
+
+    modemType* at;
+    uint8_t    mux;
+    bool       sock_connected;
+    bool       peer_closed;  // Closed by the peer but not yet stopped here
+    // Received characters that may be part of a close message; the first
+    // holdReady of them are known to be data
+    uint8_t  hold[sizeof(GSM_NO_CARRIER)];
+    uint8_t  holdLen;
+    uint8_t  holdReady;
+    uint32_t holdSince;
+  };
+
+  /*
+   * Transparent mode functions
+   */
+ protected:
+  bool exitDataModeImpl() {
+    if (!dataMode) { return true; }
+    dataMode = !thisModem().escapeDataMode();
+    return !dataMode;
+  }
+
+  bool resumeDataModeImpl() TINY_GSM_ATTR_NOT_IMPLEMENTED;
+
+  bool    dataMode = false;
+  uint8_t dataMux  = 0;  // The mux of the transparent connection
+};
+
+#endif  // SRC_TINYGSMTRANSPARENT_H_
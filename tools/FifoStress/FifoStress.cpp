@@ -0,0 +1,152 @@
+/**************************************************************
+ *
+ * Stress test and benchmark for TinyGsmFifo in its lock-free single
+ * producer/single consumer mode (TINY_GSM_FIFO_SPSC).
+ *
+ * This one runs on a host, not on a board: a producer thread and a consumer
+ * thread hammer the same fifo, using every part of the API in turn, and the
+ * consumer checks that each byte arrives exactly once and in order.
+ *
+ *   g++ -std=c++11 -O2 -pthread -I../../src FifoStress.cpp -o FifoStress
+ *   ./FifoStress [megabytes]
+ *
+ * Exits with 1 if anything is lost, repeated or reordered.
+ *
+ **************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+
+// What the blocking put()/get() do while waiting for the other side
+#define TINY_GSM_YIELD() std::this_thread::yield()
+#define TINY_GSM_FIFO_SPSC
+#include <TinyGsmFifo.h>
+
+// The byte expected at position i of the stream; not periodic in any fifo
+// size, so a slip of the indices can't go unnoticed
+static inline uint8_t pattern(uint32_t i) {
+  return static_cast<uint8_t>(i ^ (i >> 8) ^ (i >> 16));
+}
+
+template <unsigned N>
+static bool run(uint32_t total) {
+  static TinyGsmFifo<uint8_t, N> fifo;
+  fifo.clear();
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::thread producer([total] {
+    uint8_t  buf[64];
+    uint32_t pos  = 0;
+    uint8_t  mode = 0;
+    while (pos < total) {
+      uint32_t left = total - pos;
+      switch (mode++ % 4) {
+        case 0: {  // Single items
+          if (fifo.put(pattern(pos))) { pos++; }
+          break;
+        }
+        case 1: {  // Blocking copy in
+          size_t n = left < sizeof(buf) ? left : sizeof(buf);
+          for (size_t i = 0; i < n; i++) { buf[i] = pattern(pos + i); }
+          pos += fifo.put(buf, static_cast<int>(n), true);
+          break;
+        }
+        case 2: {  // Non-blocking copy in, taking what fits
+          size_t n = left < sizeof(buf) ? left : sizeof(buf);
+          for (size_t i = 0; i < n; i++) { buf[i] = pattern(pos + i); }
+          pos += fifo.put(buf, static_cast<int>(n), false);
+          break;
+        }
+        default: {  // Written in place
+          size_t   len;
+          uint8_t* span = fifo.writeSpan(len);
+          if (len > left) { len = left; }
+          for (size_t i = 0; i < len; i++) { span[i] = pattern(pos + i); }
+          fifo.commitWrite(len);
+          pos += len;
+          break;
+        }
+      }
+    }
+  });
+
+  bool     ok   = true;
+  uint32_t pos  = 0;
+  uint8_t  mode = 0;
+  uint8_t  buf[64];
+  while (ok && pos < total) {
+    uint32_t left = total - pos;
+    switch (mode++ % 4) {
+      case 0: {  // Single items, peeking first
+        int     next = fifo.peek();
+        uint8_t c;
+        if (next < 0 || !fifo.get(&c)) { break; }
+        if (c != next || c != pattern(pos)) { ok = false; }
+        pos++;
+        break;
+      }
+      case 1: {  // Blocking copy out
+        size_t n = left < sizeof(buf) ? left : sizeof(buf);
+        n        = fifo.get(buf, static_cast<int>(n), true);
+        for (size_t i = 0; i < n; i++) {
+          if (buf[i] != pattern(pos + i)) { ok = false; }
+        }
+        pos += n;
+        break;
+      }
+      case 2: {  // Non-blocking copy out, taking what's there
+        size_t n = left < sizeof(buf) ? left : sizeof(buf);
+        n        = fifo.get(buf, static_cast<int>(n), false);
+        for (size_t i = 0; i < n; i++) {
+          if (buf[i] != pattern(pos + i)) { ok = false; }
+        }
+        pos += n;
+        break;
+      }
+      default: {  // Parsed in place
+        size_t         len;
+        const uint8_t* span = fifo.readSpan(len);
+        for (size_t i = 0; i < len; i++) {
+          if (span[i] != pattern(pos + i)) { ok = false; }
+        }
+        fifo.commitRead(len);
+        pos += len;
+        break;
+      }
+    }
+  }
+  producer.join();
+
+  // Nothing may be left over once everything has been read
+  if (fifo.readable() || fifo.size() != 0) { ok = false; }
+
+  double secs = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  printf("%5u byte fifo: %s, %u bytes in %.3f s, %.1f MB/s\n", N,
+         ok ? "OK  " : "FAIL", pos, secs, pos / secs / 1e6);
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  uint32_t total = 16;
+  if (argc > 1) { total = static_cast<uint32_t>(atoi(argv[1])); }
+  total *= 1000000UL;
+
+  bool ok = true;
+  // Power of two sizes wrap with a mask, the others with a division
+  ok &= run<2>(total / 16);
+  ok &= run<64>(total);
+  ok &= run<100>(total);
+  ok &= run<1460>(total);
+  ok &= run<4096>(total);
+
+  puts(ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,363 @@
+/**************************************************************
+ *
+ * Loopback test for TinyGsmHdlc's framing.
+ *
+ * This one runs on a host, not on a board: the framer's output is fed
+ * straight back into its own receiver.  It checks the FCS against the
+ * RFC 1662 check value, that the async control character map is escaped on
+ * the wire, that a frame sent in pieces is the same as one sent whole, that
+ * aborted and overlong frames are dropped and counted, and then sends a run
+ * of random frames through a line that now and then corrupts a byte.
+ *
+ * It reuses MuxLoopback's stand-in for the Arduino core:
+ *
+ *   g++ -std=c++11 -O2 -I../MuxLoopback -I../../src HdlcLoopback.cpp \
+ *       -o HdlcLoopback
+ *   ./HdlcLoopback [frames]
+ *
+ * With --pty it instead opens a pseudo terminal for a real pppd to talk to
+ * and brings LCP up with it, acking whatever pppd asks for:
+ *
+ *   ./HdlcLoopback --pty &
+ *   pppd /dev/pts/N nodetach noauth local debug
+ *
+ * Exits with 1 if a check fails.
+ *
+ **************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deque>
+#include <vector>
+
+#include <TinyGsmHdlc.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define HDLC_LOOPBACK_PTY
+#endif
+
+// One direction of the serial line
+typedef std::deque<uint8_t> Line;
+
+// Both ends of a line that goes back to where it started.  Every noise'th
+// byte written gets a bit flipped, if noise isn't 0.
+class LoopbackPort : public Stream {
+ public:
+  size_t write(uint8_t c) override {
+    if (noise && ++written % noise == 0) { c ^= 0x10; }
+    line.push_back(c);
+    return 1;
+  }
+  using Print::write;
+
+  int available() override {
+    return static_cast<int>(line.size());
+  }
+  int read() override {
+    if (line.empty()) { return -1; }
+    int c = line.front();
+    line.pop_front();
+    return c;
+  }
+  int peek() override {
+    return line.empty() ? -1 : line.front();
+  }
+
+  Line     line;
+  uint32_t noise   = 0;
+  uint32_t written = 0;
+};
+
+// Every frame that came through
+static std::vector<std::vector<uint8_t> > received;
+
+static void onFrame(uint8_t* frame, size_t len, void*) {
+  received.push_back(std::vector<uint8_t>(frame, frame + len));
+}
+
+static bool ok = true;
+
+static void check(bool passed, const char* what) {
+  printf("%-44s %s\n", what, passed ? "OK" : "FAIL");
+  if (!passed) { ok = false; }
+}
+
+// Whether the last frame received is the given one
+static bool receivedFrame(const uint8_t* data, size_t len) {
+  return !received.empty() && received.back().size() == len &&
+      memcmp(received.back().data(), data, len) == 0;
+}
+
+// Whether anything between the flags on the line is a flag, or a control
+// character the map says should have been escaped
+static bool lineClean(const Line& line, uint32_t accm) {
+  for (size_t i = 1; i + 1 < line.size(); i++) {
+    uint8_t c = line[i];
+    if (c == 0x7E || (c < 0x20 && (accm & (1UL << c)))) { return false; }
+  }
+  return line.front() == 0x7E && line.back() == 0x7E;
+}
+
+static void runChecks(uint32_t frames) {
+  LoopbackPort port;
+  TinyGsmHdlc  hdlc(port);
+  hdlc.setFrameCallback(onFrame);
+
+  // RFC 1662 C.2: the FCS of "123456789", and the residue of a good frame
+  const uint8_t digits[] = "123456789";
+  uint16_t      fcs      = ~TinyGsmHdlc::fcs16(0xFFFF, digits, 9);
+  check(fcs == 0x906E, "FCS-16 check value");
+  uint8_t withFcs[11];
+  memcpy(withFcs, digits, 9);
+  withFcs[9]  = fcs & 0xFF;
+  withFcs[10] = fcs >> 8;
+  check(TinyGsmHdlc::fcs16(0xFFFF, withFcs, 11) == 0xF0B8, "FCS-16 residue");
+
+  // Every byte value, which with the default map escapes all controls
+  uint8_t all[256];
+  for (int i = 0; i < 256; i++) { all[i] = static_cast<uint8_t>(i); }
+  hdlc.sendFrame(all, sizeof(all));
+  check(lineClean(port.line, 0xFFFFFFFF), "Default map escapes all controls");
+  hdlc.poll();
+  check(receivedFrame(all, sizeof(all)), "Default map round trip");
+
+  // With an empty map only flag and escape are, and the receiver has to
+  // take the controls as data
+  hdlc.setTxAccm(0);
+  hdlc.setRxAccm(0);
+  hdlc.sendFrame(all, sizeof(all));
+  // 256 bytes, two of them escaped, the FCS, maybe escaped, and two flags
+  check(lineClean(port.line, 0) && port.line.size() >= 262 &&
+            port.line.size() <= 264,
+        "Empty map escapes only flag and escape");
+  hdlc.poll();
+  check(receivedFrame(all, sizeof(all)), "Empty map round trip");
+
+  // Unescaped controls the receiver's map covers are noise and get dropped
+  uint16_t bad = hdlc.badFrames();
+  hdlc.setRxAccm(0x000A0000);  // DC1 and DC3
+  hdlc.sendFrame(all, sizeof(all));
+  port.line.insert(port.line.begin() + 5, 0x11);
+  hdlc.poll();
+  check(hdlc.badFrames() == bad + 1, "Unescaped mapped controls dropped");
+  hdlc.setTxAccm(0xFFFFFFFF);
+  hdlc.setRxAccm(0xFFFFFFFF);
+  hdlc.sendFrame(all, 20);
+  port.line.insert(port.line.begin() + 5, 0x13);
+  hdlc.poll();
+  check(receivedFrame(all, 20) && hdlc.badFrames() == bad + 1,
+        "Noise dropped from a good frame");
+
+  // A frame sent in a chain of pieces is the same on the wire
+  hdlc.sendFrame(all, sizeof(all));
+  Line whole;
+  whole.swap(port.line);
+  hdlc.beginFrame();
+  hdlc.writeFrame(all, 1);
+  hdlc.writeFrame(all + 1, 0);
+  hdlc.writeFrame(all + 1, 126);
+  hdlc.writeFrame(all + 127, 129);
+  hdlc.endFrame();
+  check(port.line == whole, "Chained frame same as whole");
+  hdlc.poll();
+  check(receivedFrame(all, sizeof(all)), "Chained frame round trip");
+
+  // Aborted by the sender with an escaped flag, then a good frame
+  bad                     = hdlc.badFrames();
+  size_t        count     = received.size();
+  const uint8_t aborted[] = {0x7E, 0xFF, 0x03, 0xC0, 0x21, 0x7D, 0x7E};
+  port.line.insert(port.line.end(), aborted, aborted + sizeof(aborted));
+  hdlc.sendFrame(all, 8);
+  hdlc.poll();
+  check(hdlc.badFrames() == bad + 1 && received.size() == count + 1 &&
+            receivedFrame(all, 8),
+        "Aborted frame dropped");
+
+  // The longest frame that fits, and one byte more
+  std::vector<uint8_t> longest(TINY_GSM_HDLC_FRAME - 2);
+  for (size_t i = 0; i < longest.size(); i++) {
+    longest[i] = static_cast<uint8_t>(i * 7);
+  }
+  hdlc.sendFrame(longest.data(), longest.size());
+  hdlc.poll();
+  check(receivedFrame(longest.data(), longest.size()), "Longest frame kept");
+  bad   = hdlc.badFrames();
+  count = received.size();
+  longest.push_back(0);
+  hdlc.sendFrame(longest.data(), longest.size());
+  hdlc.sendFrame(all, 8);
+  hdlc.poll();
+  check(hdlc.badFrames() == bad + 1 && received.size() == count + 1 &&
+            receivedFrame(all, 8),
+        "Overlong frame dropped");
+
+  // Random frames, some of them hit by noise; the rest must arrive intact
+  // and in order.  A hit can also split a frame or join two.
+  received.clear();
+  bad          = hdlc.badFrames();
+  port.noise   = 4999;
+  port.written = 0;
+  std::vector<std::vector<uint8_t> > sent;
+  srand(1);
+  for (uint32_t f = 0; f < frames; f++) {
+    std::vector<uint8_t> frame(4 + rand() % 1400);
+    for (size_t i = 0; i < frame.size(); i++) {
+      frame[i] = static_cast<uint8_t>(rand());
+    }
+    hdlc.sendFrame(frame.data(), frame.size());
+    sent.push_back(frame);
+    if (rand() % 4 == 0) { hdlc.poll(); }
+  }
+  uint32_t hits = port.written / port.noise;
+  port.noise    = 0;
+  port.write(0x7E);  // Closes the last frame, in case its flag was hit
+  hdlc.poll();
+  uint16_t dropped = hdlc.badFrames() - bad;
+  size_t   next    = 0;
+  bool     inOrder = true;
+  for (size_t i = 0; i < received.size() && inOrder; i++) {
+    while (next < sent.size() && sent[next] != received[i]) { next++; }
+    inOrder = next++ < sent.size();
+  }
+  printf("%u random frames, %u bytes hit: %u received, %u dropped\n", frames,
+         hits, static_cast<unsigned>(received.size()), dropped);
+  check(inOrder && dropped > 0 && received.size() + 2 * hits >= frames &&
+            received.size() + dropped <= frames + hits,
+        "Random frames intact and in order");
+}
+
+#ifdef HDLC_LOOPBACK_PTY
+
+// The master side of a pseudo terminal
+class PtyPort : public Stream {
+ public:
+  explicit PtyPort(int fd) : fd(fd) {}
+
+  size_t write(uint8_t c) override {
+    return write(&c, 1);
+  }
+  size_t write(const uint8_t* buf, size_t size) override {
+    size_t n = 0;
+    while (n < size) {
+      ssize_t w = ::write(fd, buf + n, size - n);
+      if (w <= 0) { break; }
+      n += static_cast<size_t>(w);
+    }
+    return n;
+  }
+
+  int available() override {
+    if (len == pos) {
+      ssize_t r = ::read(fd, buf, sizeof(buf));
+      len       = r > 0 ? static_cast<size_t>(r) : 0;
+      pos       = 0;
+    }
+    return static_cast<int>(len - pos);
+  }
+  int read() override {
+    return available() ? buf[pos++] : -1;
+  }
+  int peek() override {
+    return available() ? buf[pos] : -1;
+  }
+
+ private:
+  int     fd;
+  uint8_t buf[256];
+  size_t  len = 0;
+  size_t  pos = 0;
+};
+
+struct LcpPeer {
+  TinyGsmHdlc* hdlc;
+  bool         acked  = false;  // pppd acked our Configure-Request
+  bool         acking = false;  // We acked one of pppd's
+  uint16_t     frames = 0;
+};
+
+// Acks pppd's LCP Configure-Requests in place and notes the ack of ours
+static void onLcpFrame(uint8_t* frame, size_t len, void* arg) {
+  LcpPeer* peer = static_cast<LcpPeer*>(arg);
+  peer->frames++;
+  // Address and control may be compressed away once LCP allows it
+  size_t at = (len >= 2 && frame[0] == 0xFF && frame[1] == 0x03) ? 2 : 0;
+  if (len < at + 6 || frame[at] != 0xC0 || frame[at + 1] != 0x21) {
+    printf("Ignored a frame of %u bytes\n", static_cast<unsigned>(len));
+    return;
+  }
+  uint8_t* lcp = frame + at + 2;
+  printf("LCP code %u id %u from pppd\n", lcp[0], lcp[1]);
+  if (lcp[0] == 1) {  // Configure-Request
+    lcp[0] = 2;       // Configure-Ack, with the same id and options
+    peer->hdlc->sendFrame(frame, len);
+    peer->acking = true;
+  } else if (lcp[0] == 2 && lcp[1] == 0x42) {
+    peer->acked = true;
+  } else if (lcp[0] == 5) {  // Terminate-Request
+    lcp[0] = 6;
+    peer->hdlc->sendFrame(frame, len);
+  }
+}
+
+static int runPty(unsigned long timeout) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) || unlockpt(master)) {
+    puts("Couldn't open a pseudo terminal");
+    return 1;
+  }
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+  printf("Waiting for pppd on %s\n", ptsname(master));
+  fflush(stdout);
+
+  PtyPort     port(master);
+  TinyGsmHdlc hdlc(port);
+  LcpPeer     peer;
+  peer.hdlc = &hdlc;
+  hdlc.setFrameCallback(onLcpFrame, &peer);
+
+  // Our own Configure-Request, with no options, sent until pppd acks it
+  const uint8_t request[] = {0xFF, 0x03, 0xC0, 0x21, 0x01, 0x42, 0x00, 0x04};
+  unsigned long start     = millis();
+  unsigned long lastSent  = 0;
+  bool          sent      = false;
+  while (!(peer.acked && peer.acking) && millis() - start < timeout) {
+    hdlc.poll();
+    if (peer.frames && !peer.acked && (!sent || millis() - lastSent > 1000)) {
+      sent = true;
+      hdlc.sendFrame(request, sizeof(request));
+      lastSent = millis();
+    }
+    delay(5);
+  }
+  bool up = peer.acked && peer.acking;
+  printf("%u frames from pppd, %u bad: LCP %s\n", peer.frames, hdlc.badFrames(),
+         up ? "opened" : "didn't open");
+  close(master);
+  puts(up && !hdlc.badFrames() ? "PASS" : "FAIL");
+  return up && !hdlc.badFrames() ? 0 : 1;
+}
+
+#endif
+
+int main(int argc, char** argv) {
+  if (argc > 1 && strcmp(argv[1], "--pty") == 0) {
+#ifdef HDLC_LOOPBACK_PTY
+    return runPty(argc > 2 ? strtoul(argv[2], NULL, 10) * 1000UL : 60000UL);
+#else
+    puts("No pseudo terminals here");
+    return 1;
+#endif
+  }
+
+  uint32_t frames = 2000;
+  if (argc > 1) { frames = static_cast<uint32_t>(atoi(argv[1])); }
+  runChecks(frames);
+
+  puts(ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
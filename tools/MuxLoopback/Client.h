@@ -0,0 +1,70 @@
+/**************************************************************
+ *
+ * The little of the Arduino core that TinyGsmMux needs, so that
+ * MuxLoopback can be built on a host.  Found through the <Client.h>
+ * TinyGsmCommon.h includes when ARDUINO isn't defined.
+ *
+ **************************************************************/
+
+#ifndef TOOLS_MUXLOOPBACK_CLIENT_H_
+#define TOOLS_MUXLOOPBACK_CLIENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+
+inline unsigned long millis() {
+  static auto start = std::chrono::steady_clock::now();
+  return static_cast<unsigned long>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count());
+}
+
+inline void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t size) {
+    size_t n = 0;
+    while (n < size && write(buf[n])) { n++; }
+    return n;
+  }
+  size_t print(const char* s) {
+    return write(reinterpret_cast<const uint8_t*>(s), strlen(s));
+  }
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read()      = 0;
+  virtual int peek()      = 0;
+
+  void setTimeout(unsigned long timeout) {
+    _timeout = timeout;
+  }
+
+  size_t readBytes(uint8_t* buf, size_t len) {
+    size_t        n     = 0;
+    unsigned long start = millis();
+    while (n < len && millis() - start < _timeout) {
+      int c = read();
+      if (c >= 0) { buf[n++] = static_cast<uint8_t>(c); }
+    }
+    return n;
+  }
+
+ protected:
+  unsigned long _timeout = 1000;
+};
+
+#endif  // TOOLS_MUXLOOPBACK_CLIENT_H_
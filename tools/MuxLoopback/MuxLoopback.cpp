@@ -0,0 +1,208 @@
+/**************************************************************
+ *
+ * Loopback test for TinyGsmMux's flow control.
+ *
+ * This one runs on a host, not on a board: a minimal 27.010 peer stands in
+ * for the modem and echoes every data frame back on the channel it came in
+ * on, honouring the flow control bit of the MSC's the multiplexer sends.
+ * The reader falls behind on purpose, so the channels keep filling up, and
+ * checks that every byte comes back exactly once and in order.
+ *
+ *   g++ -std=c++11 -O2 -I. -I../../src MuxLoopback.cpp -o MuxLoopback
+ *   ./MuxLoopback [kilobytes]
+ *
+ * Exits with 1 if anything is lost, repeated or reordered.
+ *
+ **************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <deque>
+#include <vector>
+
+#include <TinyGsmMux.h>
+
+// The byte expected at position i of channel dlci's data
+static inline uint8_t pattern(uint8_t dlci, uint32_t i) {
+  return static_cast<uint8_t>(i ^ (i >> 8) ^ (dlci * 0x55));
+}
+
+// One direction of the serial line
+typedef std::deque<uint8_t> Line;
+
+class LoopbackPeer;
+
+// The host's end of the serial line, which lets the peer answer whenever the
+// host looks for something to read
+class HostPort : public Stream {
+ public:
+  HostPort(Line& in, Line& out) : in(in), out(out), peer(NULL) {}
+
+  size_t write(uint8_t c) override {
+    out.push_back(c);
+    return 1;
+  }
+  using Print::write;
+
+  int available() override;
+  int read() override {
+    if (in.empty()) { return -1; }
+    int c = in.front();
+    in.pop_front();
+    return c;
+  }
+  int peek() override {
+    return in.empty() ? -1 : in.front();
+  }
+
+ private:
+  Line& in;
+  Line& out;
+
+ public:
+  LoopbackPeer* peer;
+};
+
+// The modem's end: answers SABM and DISC, answers the control channel's
+// commands and echoes the data of the other channels
+class LoopbackPeer {
+ public:
+  LoopbackPeer(Line& in, Line& out) : in(in), out(out) {}
+
+  // Takes everything the host sent, then sends up to burst frames of echo
+  // on each channel that isn't paused
+  void step(uint8_t burst) {
+    while (!in.empty()) {
+      rxByte(in.front());
+      in.pop_front();
+    }
+    for (uint8_t dlci = 1; dlci <= TINY_GSM_MUX_CHANNELS; dlci++) {
+      for (uint8_t f = 0; f < burst && !paused[dlci] && !echo[dlci].empty();
+           f++) {
+        uint8_t data[TINY_GSM_MUX_FRAME];
+        size_t  n = 0;
+        while (n < sizeof(data) && !echo[dlci].empty()) {
+          data[n++] = echo[dlci].front();
+          echo[dlci].pop_front();
+        }
+        sendFrame(dlci, 0xEF, data, n);
+      }
+    }
+  }
+
+  uint32_t pauses = 0;  // How often a channel was paused
+
+ private:
+  void sendFrame(uint8_t dlci, uint8_t control, const uint8_t* data,
+                 size_t len) {
+    uint8_t head[4] = {0xF9, static_cast<uint8_t>((dlci << 2) | 0x01), control,
+                       static_cast<uint8_t>((len << 1) | 0x01)};
+    out.insert(out.end(), head, head + 4);
+    out.insert(out.end(), data, data + len);
+    out.push_back(TinyGsmMux::fcs(head + 1, 3));
+    out.push_back(0xF9);
+  }
+
+  // Collects address, control, length, data and FCS; the data may contain
+  // flags, so frames are cut by their length.  The host never sends frames
+  // long enough to need a second length byte.
+  void rxByte(uint8_t c) {
+    if (frame.empty() && c == 0xF9) { return; }  // Between frames
+    frame.push_back(c);
+    if (frame.size() >= 3 && frame.size() == 4u + (frame[2] >> 1)) {
+      handleFrame();
+      frame.clear();
+    }
+  }
+
+  void handleFrame() {
+    uint8_t dlci    = frame[0] >> 2;
+    uint8_t control = frame[1] & ~0x10;
+    size_t  len     = frame[2] >> 1;
+
+    const uint8_t* data = &frame[3];
+    if (control == 0x2F || control == 0x43) {  // SABM or DISC
+      sendFrame(dlci, 0x63 | 0x10, NULL, 0);
+    } else if (control == 0xEF && dlci) {
+      echo[dlci].insert(echo[dlci].end(), data, data + len);
+    } else if (control == 0xEF && len >= 2) {
+      // A control channel command, answered by echoing it as a response
+      uint8_t reply[TINY_GSM_MUX_FRAME];
+      memcpy(reply, data, len);
+      reply[0] &= ~0x02;
+      sendFrame(0, 0xEF, reply, len);
+      if ((data[0] & ~0x02) == 0xE1 && len >= 4 && (data[2] >> 2) &&
+          (data[2] >> 2) <= TINY_GSM_MUX_CHANNELS) {  // MSC
+        bool pause = data[3] & 0x02;
+        if (pause && !paused[data[2] >> 2]) { pauses++; }
+        paused[data[2] >> 2] = pause;
+      }
+    }
+  }
+
+  Line&                in;
+  Line&                out;
+  std::vector<uint8_t> frame;
+  std::deque<uint8_t>  echo[TINY_GSM_MUX_CHANNELS + 1];
+  bool                 paused[TINY_GSM_MUX_CHANNELS + 1] = {};
+};
+
+int HostPort::available() {
+  if (peer) { peer->step(0); }
+  return static_cast<int>(in.size());
+}
+
+int main(int argc, char** argv) {
+  uint32_t total = 256;
+  if (argc > 1) { total = static_cast<uint32_t>(atoi(argv[1])); }
+  total *= 1000UL;
+
+  Line         toPeer, toHost;
+  HostPort     port(toHost, toPeer);
+  LoopbackPeer peer(toPeer, toHost);
+  TinyGsmMux   mux(port);
+  port.peer = &peer;
+
+  bool     ok                              = mux.begin();
+  uint32_t sent[TINY_GSM_MUX_CHANNELS + 1] = {};
+  uint32_t got[TINY_GSM_MUX_CHANNELS + 1]  = {};
+  if (!ok) { puts("The channels didn't open"); }
+
+  uint32_t rounds = 0;
+  bool     done   = !ok;
+  while (!done) {
+    done = true;
+    for (uint8_t dlci = 1; dlci <= TINY_GSM_MUX_CHANNELS; dlci++) {
+      TinyGsmMuxChannel& ch = mux.channel(dlci);
+      // Writes faster than it reads, so the echo keeps piling up
+      for (uint8_t i = 0; i < 40 && sent[dlci] < total; i++) {
+        ch.write(pattern(dlci, sent[dlci]++));
+      }
+      ch.flush();
+      for (uint8_t i = 0; i < 7 + dlci * 4 && got[dlci] < total; i++) {
+        int c = ch.read();
+        if (c < 0) { break; }
+        if (c != pattern(dlci, got[dlci]++)) { ok = false; }
+      }
+      if (got[dlci] < total) { done = false; }
+    }
+    peer.step(2);
+    // Nothing may be lost, and it must all come back eventually
+    if (mux.droppedBytes() || mux.badFrames() || ++rounds > total) {
+      ok   = false;
+      done = true;
+    }
+  }
+
+  printf("%u bytes on %u channels: %s, %u rounds, paused %u times, "
+         "%u dropped, %u bad frames\n",
+         total, TINY_GSM_MUX_CHANNELS, ok ? "OK" : "FAIL", rounds,
+         peer.pauses, mux.droppedBytes(), mux.badFrames());
+  // The test is only worth something if the channels did fill up
+  if (!peer.pauses) { ok = false; }
+
+  puts(ok ? "PASS" : "FAIL");
+  return ok ? 0 : 1;
+}
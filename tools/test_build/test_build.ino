@@ -5,12 +5,15 @@
  *
  **************************************************************/
 #include <TinyGsmClient.h>
+#include <TinyGsmHdlc.h>
+#include <TinyGsmMux.h>
 
 TinyGsm modem(Serial);
 
 void setup() {
   Serial.begin(115200);
   delay(6000);
+  TinyGsmAutoBaud(Serial, 9600, 115200, 57600);
 }
 
 void loop() {
@@ -20,6 +23,8 @@ void loop() {
   modem.init();
   modem.init("1234");
   modem.setBaud(115200);
+  modem.setFlowControl(FLOW_CONTROL_RTSCTS);
+  modem.negotiateBaud(Serial, 921600);
   modem.testAT();
 
   modem.getModemInfo();
@@ -38,6 +43,9 @@ void loop() {
   modem.waitForNetwork();
   modem.waitForNetwork(15000L);
   modem.waitForNetwork(15000L, true);
+  modem.getCachedRegStatus();
+  modem.getCachedCellId();
+  modem.getCachedAreaCode();
   modem.getSignalQuality();
   modem.getLocalIP();
   modem.localIP();
@@ -68,6 +76,8 @@ void loop() {
   TinyGsmClient client;
   TinyGsmClient client2(modem);
   TinyGsmClient client3(modem, 1);
+  TinyGsmClientRx<TinyGsmClient, 256> client4(modem, 2);
+  TinyGsmClient client5 = TinyGsmClient(modem, 0);
   client.init(&modem);
   client.init(&modem, 1);
 
@@ -89,7 +99,13 @@ void loop() {
     }
   }
 
+  TinyGsmSegment segments[] = {{"GET ", 4, false}, {GF("/"), 1, true}};
+  client.write(segments, 2);
+  client.writeFrom(Serial, 100);
+  client.pendingTxBytes();
+  client.txFreeSpace();
   client.stop();
+  client5.stop();
 
 #if defined(TINY_GSM_MODEM_HAS_SSL)
   // modem.addCertificate();  // not yet impemented
@@ -118,6 +134,39 @@ void loop() {
   client_secure.stop();
 #endif
 
+#if defined(TINY_GSM_MODEM_HAS_PPP)
+  modem.pppConnect("YourAPN");
+  modem.isPppConnected();
+  TinyGsmHdlc hdlc(Serial);
+  hdlc.setFrameCallback(NULL);
+  hdlc.setTxAccm(0);
+  hdlc.setRxAccm(0);
+  uint8_t lcp[] = {0xFF, 0x03, 0xC0, 0x21};
+  hdlc.sendFrame(lcp, sizeof(lcp));
+  hdlc.poll();
+  modem.pppDisconnect();
+#endif
+
+  // Test the multiplexer
+  TinyGsmMux mux(Serial);
+  mux.begin();
+  TinyGsm modem_mux(mux.channel(1));
+  modem_mux.testAT();
+  mux.channel(2).read();
+  mux.close(2);
+  mux.end();
+
+#if defined(TINY_GSM_MODEM_HAS_TRANSPARENT)
+  TinyGsmClientTransparent client_transparent(modem);
+  client_transparent.connect(server, 80);
+  client_transparent.print(String("GET ") + resource + " HTTP/1.0\r\n");
+  modem.isDataMode();
+  modem.exitDataMode();
+  modem.resumeDataMode();
+  client_transparent.read();
+  client_transparent.stop();
+#endif
+
 // Test the calling functions
 #if defined(TINY_GSM_MODEM_HAS_CALLING) && not defined(__AVR_ATmega32U4__)
   modem.callNumber(String("+380000000000"));